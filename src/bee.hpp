@@ -43,6 +43,11 @@
     'BEE_INCLUDE_FMT' is present)
 
     #define BEE_USE_FAKE_FMT
+
+    -- Bounds checks of BinReader, on unless NDEBUG is defined. Set it to 0
+    or 1 to force either way.
+
+    #define BEE_BIN_CHECKS 1
 */
 
 
@@ -57,28 +62,47 @@
 // ==============================================
 // ========== STD
 
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
+#include <type_traits>
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
 #include <thread>
 
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <new>
+#include <numeric>
 
 #include <filesystem>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 #include <iso646.h>
 
 // ==============================================
@@ -91,6 +115,30 @@
 #include "tcb_span.hpp"
 #endif
 
+// ==============================================
+// ========== COROUTINES
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define BEE_HAS_COROUTINES
+#endif
+
+// ==============================================
+// ========== PLATFORM
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BEE_HAS_POSIX_IO
+#endif
+
+#ifndef BEE_BIN_CHECKS
+#ifdef NDEBUG
+#define BEE_BIN_CHECKS 0
+#else
+#define BEE_BIN_CHECKS 1
+#endif
+#endif
+
 // ==============================================
 // ========== FMT
 
@@ -239,14 +287,16 @@ inline std::string format(std::string msg, std::vector<std::string> const &args)
     msg += "{ " + args[args.size() - 1] + " }";
 #else                    // Replace the {} in the string
     static const std::regex pattern("\\{:?.?:?[^\\}^ ]*\\}"); // Trying to capture fmt mini-language
-    auto args_it = args.begin();
-
-    std::sregex_iterator begin(msg.begin(), msg.end(), pattern);
-    std::sregex_iterator end;
-
-    for (auto i = begin; i != end && args_it != args.end(); ++i, ++args_it) {
-        msg.replace(i->position(), i->length(), *args_it);
-        begin = std::sregex_iterator(msg.begin(), msg.end(), pattern); // Reset iterator after modification
+    // A fresh search after every replacement, it may reallocate 'msg' under any iterator
+    size_t from = 0;
+    std::smatch match;
+    for (auto args_it = args.begin(); args_it != args.end(); ++args_it) {
+        if (!std::regex_search(msg.cbegin() + static_cast<std::ptrdiff_t>(from), msg.cend(), match, pattern)) {
+            break;
+        }
+        size_t const at = from + static_cast<size_t>(match.position());
+        msg.replace(at, static_cast<size_t>(match.length()), *args_it);
+        from = at + args_it->size();
     }
 #endif
     return msg;
@@ -345,6 +395,26 @@ public:
 #warning "[bee] :: 'mut' is already defined using it might end in a missbehave"
 #endif
 
+// ==============================================
+// ========== Scratch helpers
+
+// Rewinds this thread's scratch arena when the enclosing scope exits
+#define bee_scratch_scope()                                                                                            \
+    auto const BEE_CONCAT(scratch_mark__, __LINE__) = bee::scratch().mark();                                           \
+    defer(bee::scratch().rewind(BEE_CONCAT(scratch_mark__, __LINE__)))
+
+// ==============================================
+// ========== Lock helpers
+
+// Holds 'm' (anything with lock/unlock) until the enclosing scope exits
+#define bee_lock(m)                                                                                                    \
+    (m).lock();                                                                                                        \
+    defer((m).unlock())
+
+#define bee_lock_shared(m)                                                                                             \
+    (m).lock_shared();                                                                                                 \
+    defer((m).unlock_shared())
+
 
 // ############################################################################
 // #                                                                          #
@@ -413,6 +483,151 @@ inline constexpr f64 f64_epsilon = std::numeric_limits<f64>::epsilon();
 using namespace TypeAlias_Numbers;
 
 
+// ==============================================
+// ========== Pool Allocator
+
+// Size-class slab pool with thread-local caches, slabs live until the process ends.
+// Blocks freed on another thread are kept by that thread's cache.
+[[nodiscard]] void *pool_alloc(usize size, usize align = alignof(std::max_align_t));
+void pool_free(void *ptr, usize size, usize align = alignof(std::max_align_t));
+
+template <typename T>
+struct PoolDeleter {
+    void operator()(T *ptr) const noexcept {
+        ptr->~T();
+        pool_free(ptr, sizeof(T), alignof(T));
+    }
+};
+
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(PoolAllocator<U> const &) noexcept {}
+
+    [[nodiscard]] T *allocate(usize n) { return static_cast<T *>(pool_alloc(n * sizeof(T), alignof(T))); }
+    void deallocate(T *ptr, usize n) noexcept { pool_free(ptr, n * sizeof(T), alignof(T)); }
+
+    template <typename U>
+    [[nodiscard]] b8 operator==(PoolAllocator<U> const &) const noexcept {
+        return true;
+    }
+    template <typename U>
+    [[nodiscard]] b8 operator!=(PoolAllocator<U> const &) const noexcept {
+        return false;
+    }
+};
+
+
+// ==============================================
+// ========== Reference Counted Pointer
+
+namespace details {
+
+// Object and count share a single pooled block, there is no weak count.
+// 'Count' is a plain integer (Rc) or an atomic (Arc).
+template <typename T, typename Count>
+class RefPtr {
+    static constexpr b8 is_atomic = !std::is_integral_v<Count>;
+
+    struct Box {
+        template <typename... Args>
+        Box(Args &&...args) : count(1), value(std::forward<Args>(args)...) {}
+        Count count;
+        T value;
+    };
+
+public:
+    RefPtr() noexcept = default;
+    RefPtr(std::nullptr_t) noexcept {}
+    RefPtr(RefPtr const &other) noexcept : m_box(other.m_box) { acquire(); }
+    RefPtr(RefPtr &&other) noexcept : m_box(std::exchange(other.m_box, nullptr)) {}
+    ~RefPtr() { release(); }
+
+    RefPtr &operator=(RefPtr const &other) noexcept {
+        RefPtr(other).swap(*this);
+        return *this;
+    }
+    RefPtr &operator=(RefPtr &&other) noexcept {
+        RefPtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    template <typename... Args>
+    [[nodiscard]] static RefPtr make(Args &&...args) {
+        void *mem = pool_alloc(sizeof(Box), alignof(Box));
+        RefPtr ptr;
+        try {
+            ptr.m_box = new (mem) Box(std::forward<Args>(args)...);
+        } catch (...) {
+            pool_free(mem, sizeof(Box), alignof(Box));
+            throw;
+        }
+        return ptr;
+    }
+
+    [[nodiscard]] T *get() const noexcept { return m_box ? &m_box->value : nullptr; }
+    [[nodiscard]] T *operator->() const noexcept { return &m_box->value; }
+    [[nodiscard]] T &operator*() const noexcept { return m_box->value; }
+    [[nodiscard]] explicit operator bool() const noexcept { return m_box != nullptr; }
+
+    [[nodiscard]] u32 use_count() const noexcept {
+        if (!m_box) {
+            return 0;
+        }
+        if constexpr (is_atomic) {
+            return m_box->count.load(std::memory_order_relaxed);
+        } else {
+            return m_box->count;
+        }
+    }
+
+    void reset() noexcept { RefPtr().swap(*this); }
+    void swap(RefPtr &other) noexcept { std::swap(m_box, other.m_box); }
+
+    [[nodiscard]] b8 operator==(RefPtr const &other) const noexcept { return m_box == other.m_box; }
+    [[nodiscard]] b8 operator!=(RefPtr const &other) const noexcept { return m_box != other.m_box; }
+
+private:
+    void acquire() noexcept {
+        if (!m_box) {
+            return;
+        }
+        if constexpr (is_atomic) {
+            m_box->count.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            ++m_box->count;
+        }
+    }
+
+    void release() noexcept {
+        if (!m_box) {
+            return;
+        }
+        if constexpr (is_atomic) {
+            if (m_box->count.fetch_sub(1, std::memory_order_release) != 1) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } else {
+            if (--m_box->count != 0) {
+                return;
+            }
+        }
+        m_box->~Box();
+        pool_free(m_box, sizeof(Box), alignof(Box));
+        m_box = nullptr;
+    }
+
+    Box *m_box = nullptr;
+};
+
+} // namespace details
+
+
 // ==============================================
 // ========== Pointers Aliases
 
@@ -434,6 +649,42 @@ template <typename T, typename... Args>
     return std::make_shared<T>(std::forward<Args>(args)...);
 }
 
+// Pooled unique pointer
+template <typename T>
+using Pptr = std::unique_ptr<T, PoolDeleter<T>>;
+template <typename T, typename... Args>
+[[nodiscard]] Pptr<T> Pnew(Args &&...args) {
+    void *mem = pool_alloc(sizeof(T), alignof(T));
+    try {
+        return Pptr<T>(new (mem) T(std::forward<Args>(args)...));
+    } catch (...) {
+        pool_free(mem, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+// Pooled shared pointer (object and control block in a single pool block)
+template <typename T, typename... Args>
+[[nodiscard]] Sptr<T> PSnew(Args &&...args) {
+    return std::allocate_shared<T>(PoolAllocator<T> {}, std::forward<Args>(args)...);
+}
+
+// Single-threaded reference counted pointer
+template <typename T>
+using Rc = details::RefPtr<T, u32>;
+template <typename T, typename... Args>
+[[nodiscard]] Rc<T> Rnew(Args &&...args) {
+    return Rc<T>::make(std::forward<Args>(args)...);
+}
+
+// Thread-safe reference counted pointer
+template <typename T>
+using Arc = details::RefPtr<T, std::atomic<u32>>;
+template <typename T, typename... Args>
+[[nodiscard]] Arc<T> Anew(Args &&...args) {
+    return Arc<T>::make(std::forward<Args>(args)...);
+}
+
 } // namespace TypeAlias_Pointers
 using namespace TypeAlias_Pointers;
 
@@ -530,6 +781,12 @@ inline constexpr f64 ns_to_us = 1e-3;
 // ==============================================
 // ========== Elapsed Timer
 
+// Single monotonic tick source for timers, never goes backwards
+using MonoClock = std::chrono::steady_clock;
+[[nodiscard]] inline i64 mono_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(MonoClock::now().time_since_epoch()).count();
+}
+
 class ElapsedTimer {
 public:
     void reset();
@@ -543,13 +800,91 @@ private:
     [[nodiscard]] i64 elapsed() const;
 
 private:
-    using Clock = std::chrono::high_resolution_clock;
-    Clock::time_point m_ref = Clock::now();
+    i64 m_ref = mono_now_ns();
     b8 m_valid = false;
 };
 using ETimer = ElapsedTimer;
 
 
+// ==============================================
+// ========== Timer Wheel
+
+// Timer ids follow the SlotHandle layout: generation high, node low, zero is never valid
+using TimerId = u64;
+inline constexpr TimerId timer_null = 0;
+
+// Hierarchical timing wheel: 4 levels of 256 slots, each level covering 256x
+// the range of the one below (2^32 ticks total, farther deadlines get
+// re-cascaded). Timers are nodes of a flat pool linked by index, so schedule
+// and cancel are O(1) and never allocate once the pool is warm.
+class TimerWheel {
+public:
+    explicit TimerWheel(i64 tick_ns = 1'000'000, i64 start_ns = mono_now_ns());
+
+    TimerId schedule_at(i64 deadline_ns, u64 data = 0);
+    TimerId schedule_in(i64 delay_ns, u64 data = 0) { return schedule_at(now_ns() + delay_ns, data); }
+    b8 cancel(TimerId id);
+    [[nodiscard]] b8 pending(TimerId id) const;
+
+    // Fires every timer due at 'now_ns' as on_expire(TimerId, u64 data), returns how many fired.
+    // Expired timers are collected first, so callbacks may schedule or cancel freely.
+    template <typename F>
+    usize advance(i64 now_ns, F &&on_expire) {
+        Vec<Expired> expired;
+        std::swap(expired, m_expired);
+        expired.clear();
+        collect(now_ns, expired);
+        for (Expired const &timer : expired) {
+            on_expire(timer.id, timer.data);
+        }
+        usize const count = expired.size();
+        std::swap(expired, m_expired);
+        return count;
+    }
+
+    void reserve(usize timers);
+    void clear();
+    [[nodiscard]] usize size() const { return m_size; }
+    [[nodiscard]] i64 now_ns() const { return m_start_ns + as(i64, m_tick) * m_tick_ns; }
+    [[nodiscard]] i64 tick_ns() const { return m_tick_ns; }
+
+private:
+    static constexpr u32 levels = 4;
+    static constexpr u32 slot_bits = 8;
+    static constexpr u32 slots = 1u << slot_bits;
+    static constexpr u32 nil = ~0u;
+
+    struct Node {
+        u64 deadline = 0; // In ticks
+        u64 data = 0;
+        u32 prev = nil;
+        u32 next = nil;
+        u32 bucket = nil;
+        u32 generation = 0; // Odd while scheduled
+    };
+    struct Expired {
+        TimerId id;
+        u64 data;
+    };
+
+    void collect(i64 now_ns, Vec<Expired> &out);
+    void place(u32 index);
+    void unlink(u32 index);
+    void release(u32 index);
+    void cascade(u32 level);
+
+    i64 m_tick_ns;
+    i64 m_start_ns;
+    u64 m_tick = 0;
+    usize m_size = 0;
+    Vec<Node> m_nodes;
+    Vec<u32> m_free;
+    Vec<u32> m_buckets = Vec<u32>(levels * slots, nil);
+    Arr<usize, levels> m_level_sizes {};
+    Vec<Expired> m_expired;
+};
+
+
 // ==============================================
 // ========== String Utils
 
@@ -572,10 +907,62 @@ using ETimer = ElapsedTimer;
 [[nodiscard]] Str str_trim_r(Str str, Str const &individual_chars_to_remove = " \n\r\t");
 
 
+// ==============================================
+// ========== Hashing
+
+namespace details {
+
+// 64x64 -> 128 multiply folded back to 64 bits, the core of the bee hasher
+[[nodiscard]] inline u64 hash_mix(u64 a, u64 b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t const r = as(__uint128_t, a) * b;
+    return as(u64, r) ^ as(u64, r >> 64);
+#else
+    // Four 32x32 partial products, the middle column carries into the high word
+    u64 const ll = (a & 0xffffffff) * (b & 0xffffffff);
+    u64 const lh = (a & 0xffffffff) * (b >> 32);
+    u64 const hl = (a >> 32) * (b & 0xffffffff);
+    u64 const hh = (a >> 32) * (b >> 32);
+    u64 const mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+    u64 const hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (a * b) ^ hi;
+#endif
+}
+
+} // namespace details
+
+// Fast non-cryptographic hash (wyhash style), NOT suitable against hash flooding
+[[nodiscard]] u64 hash_bytes(void const *data, usize size, u64 seed = 0);
+[[nodiscard]] inline u64 hash_u64(u64 value) {
+    return details::hash_mix(value ^ 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull);
+}
+
+// Transparent hasher: strings hash by content whatever their type, so a
+// Umap<Str, T, Hasher, std::equal_to<>> can be looked up with a string_view
+struct Hasher {
+    using is_transparent = void;
+
+    template <typename T>
+    [[nodiscard]] usize operator()(T const &value) const {
+        if constexpr (std::is_convertible_v<T const &, std::string_view>) {
+            std::string_view const view = value;
+            return as(usize, hash_bytes(view.data(), view.size()));
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            return as(usize, hash_u64(as(u64, value)));
+        } else if constexpr (std::is_pointer_v<T>) {
+            return as(usize, hash_u64(recast(u64, value)));
+        } else {
+            return std::hash<T> {}(value);
+        }
+    }
+};
+
+
 // ==============================================
 // ========== Binary Utils
 
 [[nodiscard]] Vec<u8> bin_read(Str const &path);
+b8 bin_read(Str const &path, Vec<u8> &out); // Reuses 'out' capacity, no reallocation when it is big enough
 [[nodiscard]] b8 bin_check_magic(SpanConst<u8> bin, SpanConst<u8> magic);
 
 
@@ -583,6 +970,7 @@ using ETimer = ElapsedTimer;
 // ========== Files Utils
 
 [[nodiscard]] Str file_read(Str const &input_file);
+b8 file_read(Str const &input_file, Str &out);
 
 b8 file_write_append(Str const &output_file, Str const &to_write);
 b8 file_write_trunc(Str const &output_file, Str const &to_write);
@@ -594,146 +982,3001 @@ b8 file_check_extension(Str const &input_file, Str ext);
 
 
 // ==============================================
-// ========== Math Utils
+// ========== File Writer
 
-[[nodiscard]] f32 map(f32 value, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax);
-[[nodiscard]] f32 map_100(f32 value, f32 dstMin, f32 dstMax);
+enum class WriteMode : u8 { Append, Trunc };
 
-[[nodiscard]] b8 fuzzy_eq(f32 f1, f32 f2, f32 threshold = 0.01f);
+// When a FileWriter calls fsync, all zero means never. Time and size based
+// syncs are checked whenever data actually reaches the file.
+struct FsyncPolicy {
+    usize every_bytes = 0;
+    f64 every_ms = 0;
+    b8 on_close = false;
+};
 
-[[nodiscard]] f32 clamp_angle(f32 angle);
+// Keeps the file open and gathers writes in a block, so many small appends
+// cost one syscall per block instead of an open/write/close each. Writes that
+// do not fit go out together with the pending block in a single writev.
+class FileWriter {
+    bee_nocopy(FileWriter);
 
-#ifdef BEE_INCLUDE_GLM
-[[nodiscard]] b8 fuzzy_eq(Vec2 const &v1, Vec2 const &v2, f32 t = 0.01f);
-[[nodiscard]] b8 fuzzy_eq(Vec3 const &v1, Vec3 const &v2, f32 t = 0.01f);
-[[nodiscard]] b8 fuzzy_eq(Vec4 const &v1, Vec4 const &v2, f32 t = 0.01f);
+public:
+    FileWriter() = default;
+    explicit FileWriter(Str const &path, WriteMode mode = WriteMode::Append, FsyncPolicy fsync = {},
+                        usize buffer_size = 64 * 1024) {
+        open(path, mode, fsync, buffer_size);
+    }
+    FileWriter(FileWriter &&other) noexcept { *this = std::move(other); }
+    FileWriter &operator=(FileWriter &&other) noexcept;
+    ~FileWriter() { close(); }
 
-template <typename T>
-[[nodiscard]] inline b8 is_aligned(T const &a, T const &b, f32 margin = 0.f) {
-    return abs(glm::dot(glm::normalize(a), glm::normalize(b))) >= (1.f - f32_epsilon - margin);
-}
-#endif
+    b8 open(Str const &path, WriteMode mode = WriteMode::Append, FsyncPolicy fsync = {},
+            usize buffer_size = 64 * 1024);
+    b8 close();
 
-} // namespace bee
+    b8 write(void const *data, usize size);
+    b8 write(std::string_view text) { return write(text.data(), text.size()); }
+    b8 write(SpanConst<u8> bytes) { return write(bytes.data(), bytes.size()); }
+    b8 writev(SpanConst<std::string_view> parts);
 
+    b8 flush();
+    b8 sync(); // Flush and fsync now, whatever the policy
 
-// ############################################################################
-// #                                                                          #
-// #                                                                          #
-// #                            IMPLEMENTATION                                #
-// #                                                                          #
-// #                                                                          #
-// ############################################################################
+    [[nodiscard]] b8 is_open() const { return m_fd >= 0; }
+    explicit operator bool() const { return is_open(); }
+    [[nodiscard]] u64 bytes_written() const { return m_written; }
+    [[nodiscard]] u64 position() const { return m_start + m_written; } // File offset of the next byte
+    [[nodiscard]] u64 sync_count() const { return m_syncs; }
 
-#ifdef BEE_IMPLEMENTATION
+private:
+    b8 write_parts(SpanConst<std::string_view> parts);
+    void apply_policy(usize flushed);
+
+    i32 m_fd = -1;
+    Str m_path;
+    Vec<u8> m_buffer;
+    usize m_capacity = 0;
+    FsyncPolicy m_fsync;
+    usize m_unsynced = 0;
+    ETimer m_since_sync;
+    u64 m_start = 0; // File size when opened, appends start there
+    u64 m_written = 0;
+    u64 m_syncs = 0;
+};
 
-#ifndef __BEE_IMPLEMENTATION_GUARD
-#define __BEE_IMPLEMENTATION_GUARD
 
-#include <fstream>
+// ==============================================
+// ========== Durable Writes
+
+// Crash-safe replace: writes a temp file next to 'output_file', fsyncs it,
+// renames it over the target and fsyncs the directory. Readers, and the file
+// after a crash, see either the old contents or the new ones, never a mix.
+// An existing target keeps its permissions.
+b8 file_write_atomic(Str const &output_file, std::string_view contents);
+b8 file_write_atomic(Str const &output_file, char const *data, usize data_size);
+
+// Copies into a temp file next to 'to' with the permissions of 'from', then
+// renames it over 'to': a failed copy leaves the target as it was. Fails when
+// both name the same file. On Linux the bytes never reach user space
+// (copy_file_range, then sendfile), other POSIX systems use a read/write loop
+// and the rest fs::copy_file.
+b8 file_copy(Str const &from, Str const &to);
 
-namespace bee {
-namespace fs = std::filesystem;
 
 // ==============================================
-// ========== Elapsed Timer
+// ========== Binary Cursors
 
-void ElapsedTimer::reset() {
-    m_valid = true;
-    m_ref = Clock::now();
-}
-f64 ElapsedTimer::elapsed_s() const { return as(f64, elapsed()) * ns_to_s; }
-f64 ElapsedTimer::elapsed_ms() const { return as(f64, elapsed()) * ns_to_ms; }
-f64 ElapsedTimer::elapsed_us() const { return as(f64, elapsed()) * ns_to_us; }
-f64 ElapsedTimer::elapsed_ns() const { return as(f64, elapsed()); }
-b8 ElapsedTimer::is_valid() const { return m_valid; }
-i64 ElapsedTimer::elapsed() const {
-    auto const now = Clock::now();
-    return std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_ref).count();
-}
+enum class Endian : u8 {
+    Little,
+    Big,
+    Native = std::endian::native == std::endian::little ? Little : Big,
+};
 
+namespace details {
 
-// ==============================================
-// ========== String Utils
+// Up to 8 bytes, so no long double: its size and padding differ between platforms
+template <typename T>
+concept BinScalar = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
 
-Str str_lower(Str str) {
-    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
-    return str;
-}
-Str str_upper(Str str) {
-    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
-    return str;
-}
-Str str_capital(Str str) {
-    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
-    std::transform(str.begin(), str.begin() + 1, str.begin(), ::toupper);
-    return str;
+template <typename T>
+[[nodiscard]] constexpr T byte_swap(T value) {
+    T out = 0;
+    for (usize i = 0; i < sizeof(T); ++i) { // Recognized as a single bswap
+        out = as(T, (out << 8) | (value & 0xff));
+        value = as(T, value >> 8);
+    }
+    return out;
 }
 
-b8 str_contains(Str const &str, Str const &substr) { return str.find(substr) < str.size(); }
+template <BinScalar T>
+using BinBits = std::conditional_t<sizeof(T) == 1, u8,
+                                   std::conditional_t<sizeof(T) == 2, u16,
+                                                      std::conditional_t<sizeof(T) == 4, u32, u64>>>;
 
-Vec<Str> str_split(Str const &str, Str const &delimeter) {
+} // namespace details
 
-    Str token;
-    Vec<Str> splitted;
-    usize ini = 0;
-    usize end = 0;
+// Cursor over bytes that are already in memory (bin_read, MappedFile, ...).
+// Strings and POD arrays come back as views into those bytes, nothing is
+// copied. With BEE_BIN_CHECKS a read past the end returns zero / an empty
+// view and the reader stays failed (check 'ok()' once at the end); without
+// it reads are unchecked, so only use it on trusted input.
+class BinReader {
+public:
+    BinReader() = default;
+    explicit BinReader(SpanConst<u8> data) : m_data(data) {}
 
-    // Split and store the string body
-    while ((end = str.find(delimeter, ini)) < str.size()) {
-        token = str.substr(ini, end - ini);
-        ini = end + delimeter.size();
-        splitted.push_back(token);
+    template <details::BinScalar T>
+    [[nodiscard]] T read(Endian endian = Endian::Little) {
+        if (!has(sizeof(T))) {
+            return T {};
+        }
+        details::BinBits<T> bits;
+        std::memcpy(&bits, m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return std::bit_cast<T>(endian == Endian::Native ? bits : details::byte_swap(bits));
+    }
+    template <details::BinScalar T>
+    [[nodiscard]] T read_be() {
+        return read<T>(Endian::Big);
     }
 
-    // Store the string tail
-    if (ini < str.size()) {
-        token = str.substr(ini);
-        splitted.push_back(token);
+    // LEB128, and its zigzag variant for signed values
+    [[nodiscard]] u64 read_varint() {
+        u64 value = 0;
+        for (u32 shift = 0; shift < 64; shift += 7) {
+            if (!has(1)) {
+                return 0;
+            }
+            u8 const byte = m_data[m_pos++];
+            if (shift == 63 && byte > 1) { // Bits past the 64th, or an eleventh byte
+                fail();
+                return 0;
+            }
+            value |= as(u64, byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        return 0; // Unreachable, the tenth byte either ends the value or fails
+    }
+    [[nodiscard]] i64 read_varint_signed() {
+        u64 const zigzag = read_varint();
+        return as(i64, zigzag >> 1) ^ -as(i64, zigzag & 1);
     }
 
-    return splitted;
-}
+    [[nodiscard]] SpanConst<u8> read_bytes(usize size) {
+        if (!has(size)) {
+            return {};
+        }
+        SpanConst<u8> const bytes = m_data.subspan(m_pos, size);
+        m_pos += size;
+        return bytes;
+    }
+    [[nodiscard]] std::string_view read_str(usize size) {
+        SpanConst<u8> const bytes = read_bytes(size);
+        return { recast(char const *, bytes.data()), bytes.size() };
+    }
+    [[nodiscard]] std::string_view read_str() { return read_str(as(usize, read_varint())); } // Varint length prefix
+
+    // In native layout. The data must be suitably aligned for T in memory:
+    // buffers from bin_read or MappedFile start aligned, so a writer's 'align'
+    // (which counts from the start of the buffer or file) before 'write_span'
+    // is enough when this reader covers the whole file.
+    template <typename T>
+    [[nodiscard]] SpanConst<T> read_span(usize count) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be viewed in place");
+#if BEE_BIN_CHECKS
+        if (count > (m_data.size() - std::min(m_pos, m_data.size())) / sizeof(T) ||
+            recast(uintptr_t, m_data.data() + m_pos) % alignof(T) != 0) {
+            fail();
+            return {};
+        }
+#endif
+        SpanConst<u8> const bytes = read_bytes(count * sizeof(T));
+        return { recast(T const *, bytes.data()), count };
+    }
 
-Str str_join(Vec<Str> const &strlist, Str const &delimeter) {
+    b8 skip(usize size) { return !read_bytes(size).empty() || size == 0; }
+    b8 align(usize alignment) { return skip((alignment - m_pos % alignment) % alignment); } // From the data start
+    b8 seek(usize position) {
+        if (position > m_data.size()) {
+            fail();
+            return false;
+        }
+        m_pos = position;
+        return true;
+    }
 
-    if (strlist.empty()) {
-        return "";
+    [[nodiscard]] b8 ok() const { return !m_failed; }
+    [[nodiscard]] usize position() const { return m_pos; }
+    [[nodiscard]] usize size() const { return m_data.size(); }
+    [[nodiscard]] usize remaining() const { return m_data.size() - m_pos; }
+    [[nodiscard]] b8 at_end() const { return m_pos >= m_data.size(); }
+
+private:
+    [[nodiscard]] b8 has([[maybe_unused]] usize size) {
+#if BEE_BIN_CHECKS
+        if (m_failed || size > m_data.size() - m_pos) {
+            fail();
+            return false;
+        }
+#endif
+        return true;
+    }
+    void fail() {
+        m_failed = true;
+        m_pos = m_data.size(); // Later reads fail too instead of decoding garbage
     }
 
-    Str s;
-    for (usize i = 0; i < strlist.size() - 1; ++i) {
-        s += strlist[i] + delimeter;
+    SpanConst<u8> m_data;
+    usize m_pos = 0;
+    b8 m_failed = false;
+};
+
+// Appends the same encodings to a growable buffer or through a FileWriter
+// (which already batches small writes).
+class BinWriter {
+public:
+    explicit BinWriter(Vec<u8> &out) : m_buffer(&out) {}
+    explicit BinWriter(FileWriter &out) : m_file(&out) {}
+
+    template <details::BinScalar T>
+    b8 write(T value, Endian endian = Endian::Little) {
+        auto const bits = std::bit_cast<details::BinBits<T>>(value);
+        auto const ordered = endian == Endian::Native ? bits : details::byte_swap(bits);
+        return put(&ordered, sizeof(T));
+    }
+    template <details::BinScalar T>
+    b8 write_be(T value) {
+        return write(value, Endian::Big);
     }
-    s += strlist[strlist.size() - 1];
 
-    return s;
-}
+    b8 write_varint(u64 value) {
+        Arr<u8, 10> bytes;
+        usize size = 0;
+        do {
+            bytes[size++] = as(u8, (value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+            value >>= 7;
+        } while (value > 0);
+        return put(bytes.data(), size);
+    }
+    b8 write_varint_signed(i64 value) { return write_varint((as(u64, value) << 1) ^ as(u64, value >> 63)); }
 
-Str str_replace(Str str, Str const &from, Str const &to, b8 only_first_match) {
-    usize pos = 0;
-    while ((pos = str.find(from)) < str.size()) {
-        str.replace(pos, from.length(), to);
-        if (only_first_match) {
-            break;
+    b8 write_bytes(SpanConst<u8> bytes) { return put(bytes.data(), bytes.size()); }
+    b8 write_str(std::string_view text) { return write_varint(text.size()) && put(text.data(), text.size()); }
+
+    // Native layout, see 'BinReader::read_span'
+    template <typename T>
+    b8 write_span(SpanConst<T> items) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be written as is");
+        return put(items.data(), items.size_bytes());
+    }
+    // Zero padding up to a multiple of 'alignment', counted from the start of
+    // the buffer or file (not from this writer's first byte) like a reader sees it
+    b8 align(usize alignment) {
+        constexpr Arr<u8, 64> zeros {};
+        u64 const offset = m_buffer ? m_buffer->size() : m_file->position();
+        usize padding = as(usize, (alignment - offset % alignment) % alignment);
+        b8 ok = true;
+        for (; padding > 0 && ok; padding -= std::min(padding, zeros.size())) {
+            ok = put(zeros.data(), std::min(padding, zeros.size()));
         }
+        return ok;
     }
-    return str;
-}
 
-Str str_replace_many(Str str, Vec<Str> const &from, Vec<Str> const &to, b8 sorted) {
+    [[nodiscard]] b8 ok() const { return !m_failed; }
+    [[nodiscard]] u64 size() const { return m_written; }
 
-    b8 const same_size = from.size() == to.size();
-    b8 const is_empty = same_size && from.size() < 1;
-    if (!same_size || is_empty) {
-        if (!same_size) {
-            assert(0);
+private:
+    b8 put(void const *data, usize size) {
+        m_written += size;
+        if (m_buffer) {
+            auto const *bytes = recast(u8 const *, data);
+            m_buffer->insert(m_buffer->end(), bytes, bytes + size);
+            return true;
         }
-        return str;
+        b8 const written = m_file->write(data, size);
+        m_failed |= !written;
+        return written;
     }
 
-    usize pos = 0;
-    usize i = 0;
+    Vec<u8> *m_buffer = nullptr;
+    FileWriter *m_file = nullptr;
+    u64 m_written = 0;
+    b8 m_failed = false;
+};
+
+
+// ==============================================
+// ========== Mapped Files
+
+// Access pattern hints forwarded to madvise, combinable with '|'
+enum class MapHint : u32 {
+    None = 0,
+    Sequential = bee_bit(0),
+    Random = bee_bit(1),
+    WillNeed = bee_bit(2), // Start paging in the whole file right away
+    HugePages = bee_bit(3),
+    Copy = bee_bit(4), // Read into a heap buffer instead, a snapshot later writes can't change
+};
+[[nodiscard]] constexpr MapHint operator|(MapHint l, MapHint r) { return as(MapHint, as(u32, l) | as(u32, r)); }
+[[nodiscard]] constexpr b8 operator&(MapHint l, MapHint r) { return (as(u32, l) & as(u32, r)) != 0; }
+
+// Read-only view of a whole file. Mapped with mmap on POSIX, pages are only
+// read on first touch and shared with the page cache, so nothing is copied.
+// Writes to the file show through, and touching pages past its end after a
+// truncation raises SIGBUS: use MapHint::Copy for files others may rewrite.
+// Elsewhere it falls back to reading the file into a heap buffer.
+class MappedFile {
+    bee_nocopy(MappedFile);
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(Str const &path, MapHint hints = MapHint::Sequential) { open(path, hints); }
+    MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile() { close(); }
+
+    b8 open(Str const &path, MapHint hints = MapHint::Sequential);
+    void close();
+    b8 advise(MapHint hints) const;
+
+    [[nodiscard]] b8 is_open() const { return m_open; }
+    explicit operator bool() const { return m_open; }
+    [[nodiscard]] b8 is_mapped() const { return m_mapped; }
+
+    [[nodiscard]] u8 const *data() const { return m_data; }
+    [[nodiscard]] usize size() const { return m_size; }
+    [[nodiscard]] b8 empty() const { return m_size == 0; }
+    [[nodiscard]] SpanConst<u8> bytes() const { return { m_data, m_size }; }
+    [[nodiscard]] std::string_view view() const { return { recast(char const *, m_data), m_size }; }
+    operator SpanConst<u8>() const { return bytes(); }
+
+private:
+    u8 const *m_data = nullptr;
+    usize m_size = 0;
+    b8 m_open = false;
+    b8 m_mapped = false;
+    Vec<u8> m_heap; // Fallback storage when mmap is not available
+};
+
+// Both return a closed MappedFile (and log) when the file can't be opened
+[[nodiscard]] MappedFile file_view(Str const &path, MapHint hints = MapHint::Sequential);
+[[nodiscard]] MappedFile bin_view(Str const &path, MapHint hints = MapHint::Sequential);
+
+
+// ==============================================
+// ========== Record Reader
+
+// Streams a file in fixed-size chunks, whatever its size. A background thread
+// reads the next chunk while the current one is being split, so memory stays
+// at two chunks (plus the longest record that crosses a chunk boundary).
+class RecordReader {
+    bee_nocopy_nomove(RecordReader);
+
+public:
+    explicit RecordReader(Str const &path, char delimiter = '\n', usize chunk_size = 1 << 20);
+    ~RecordReader();
+
+    // Next record without its delimiter. The view stays valid until the next call.
+    // A trailing delimiter does not yield an empty last record.
+    [[nodiscard]] b8 next(std::string_view &record);
+
+    template <typename F>
+    void for_each(F &&fn) {
+        std::string_view record;
+        while (next(record)) {
+            fn(record);
+        }
+    }
+
+    [[nodiscard]] b8 is_open() const { return m_fd >= 0; }
+    explicit operator bool() const { return is_open(); }
+    [[nodiscard]] b8 failed() const { return m_failed; }
+    [[nodiscard]] u64 records() const { return m_records; }
+    [[nodiscard]] u64 bytes_read() const { return m_bytes; }
+
+protected:
+    b8 m_trim_cr = false;
+
+private:
+    b8 swap_chunks();
+    void read_ahead();
+
+    Str m_path;
+    i32 m_fd = -1;
+    char m_delimiter;
+
+    Vec<char> m_front;
+    usize m_front_size = 0;
+    usize m_cursor = 0;
+    Str m_carry; // Record crossing a chunk boundary
+    b8 m_eof = false;
+    b8 m_failed = false;
+    u64 m_records = 0;
+    u64 m_bytes = 0;
+
+    Vec<char> m_back; // Owned by the reader thread until 'm_back_ready'
+    usize m_back_size = 0;
+    b8 m_back_ready = false;
+    b8 m_back_failed = false;
+    b8 m_stop = false;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+// Lines split on '\n', a trailing '\r' is dropped
+class LineReader : public RecordReader {
+public:
+    explicit LineReader(Str const &path, usize chunk_size = 1 << 20) : RecordReader(path, '\n', chunk_size) {
+        m_trim_cr = true;
+    }
+};
+
+
+// ==============================================
+// ========== Math Utils
+
+[[nodiscard]] f32 map(f32 value, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax);
+[[nodiscard]] f32 map_100(f32 value, f32 dstMin, f32 dstMax);
+
+[[nodiscard]] b8 fuzzy_eq(f32 f1, f32 f2, f32 threshold = 0.01f);
+
+[[nodiscard]] f32 clamp_angle(f32 angle);
+
+// Batched versions, written to be auto-vectorized
+void map(SpanConst<f32> values, Span<f32> out, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax);
+[[nodiscard]] b8 fuzzy_eq(SpanConst<f32> v1, SpanConst<f32> v2, f32 threshold = 0.01f);
+
+#ifdef BEE_INCLUDE_GLM
+[[nodiscard]] b8 fuzzy_eq(Vec2 const &v1, Vec2 const &v2, f32 t = 0.01f);
+[[nodiscard]] b8 fuzzy_eq(Vec3 const &v1, Vec3 const &v2, f32 t = 0.01f);
+[[nodiscard]] b8 fuzzy_eq(Vec4 const &v1, Vec4 const &v2, f32 t = 0.01f);
+
+template <typename T>
+[[nodiscard]] inline b8 is_aligned(T const &a, T const &b, f32 margin = 0.f) {
+    return abs(glm::dot(glm::normalize(a), glm::normalize(b))) >= (1.f - f32_epsilon - margin);
+}
+#endif
+
+
+// ==============================================
+// ========== Scratch Allocator
+
+// Stack-like bump allocator. Memory is never given back, only rewound to a
+// previous mark, so pointers stay valid until the rewind that covers them.
+class ScratchArena {
+public:
+    struct Mark {
+        usize block = 0;
+        usize offset = 0;
+    };
+
+    explicit ScratchArena(usize block_size = 1 << 20);
+
+    [[nodiscard]] void *alloc(usize size, usize align = alignof(std::max_align_t));
+
+    [[nodiscard]] Mark mark() const;
+    void rewind(Mark mark);
+    void reset();
+
+    [[nodiscard]] usize used() const;
+    [[nodiscard]] usize capacity() const;
+
+private:
+    struct Block {
+        Uptr<u8[]> data = nullptr;
+        usize size = 0;
+    };
+
+    Vec<Block> m_blocks;
+    usize m_block = 0;
+    usize m_offset = 0;
+    usize m_block_size = 0;
+};
+
+// This thread's arena, wrap its usage with 'bee_scratch_scope()'
+[[nodiscard]] ScratchArena &scratch();
+
+template <typename T>
+class ScratchAllocator {
+public:
+    using value_type = T;
+
+    ScratchAllocator() noexcept : m_arena(&scratch()) {}
+    ScratchAllocator(ScratchArena &arena) noexcept : m_arena(&arena) {}
+    template <typename U>
+    ScratchAllocator(ScratchAllocator<U> const &other) noexcept : m_arena(other.arena()) {}
+
+    [[nodiscard]] T *allocate(usize n) { return static_cast<T *>(m_arena->alloc(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, usize) noexcept {}
+
+    [[nodiscard]] ScratchArena *arena() const noexcept { return m_arena; }
+
+    template <typename U>
+    [[nodiscard]] b8 operator==(ScratchAllocator<U> const &other) const noexcept {
+        return m_arena == other.arena();
+    }
+    template <typename U>
+    [[nodiscard]] b8 operator!=(ScratchAllocator<U> const &other) const noexcept {
+        return m_arena != other.arena();
+    }
+
+private:
+    ScratchArena *m_arena = nullptr;
+};
+
+// Growth leaves the old buffer behind until the rewind, reserve when possible
+template <typename T>
+using ScratchVec = std::vector<T, ScratchAllocator<T>>;
+using ScratchStr = std::basic_string<char, std::char_traits<char>, ScratchAllocator<char>>;
+
+
+// ==============================================
+// ========== Slot Map
+
+// Generation in the high 32 bits, slot in the low 32 bits, zero is never valid
+using SlotHandle = u64;
+inline constexpr SlotHandle slot_null = 0;
+
+// Values are kept dense (swap-remove) so iteration is a plain array walk,
+// handles go through a slot table and detect stale references.
+template <typename T>
+class SlotMap {
+public:
+    template <typename... Args>
+    SlotHandle emplace(Args &&...args) {
+        // Value first, a throwing constructor must not leave a live slot behind
+        m_values.emplace_back(std::forward<Args>(args)...);
+        b8 const reuse = m_free != npos;
+        u32 const slot_index = reuse ? m_free : as(u32, m_slots.size());
+        try {
+            if (!reuse) {
+                m_slots.push_back({ npos, 0 });
+            }
+            m_owners.push_back(slot_index);
+        } catch (...) {
+            if (!reuse && m_slots.size() > slot_index) {
+                m_slots.pop_back();
+            }
+            m_values.pop_back();
+            throw;
+        }
+
+        auto &slot = m_slots[slot_index];
+        if (reuse) {
+            m_free = slot.index;
+        }
+        slot.index = as(u32, m_values.size() - 1);
+        slot.generation++; // Odd means alive
+        return (as(u64, slot.generation) << 32) | slot_index;
+    }
+    SlotHandle insert(T value) { return emplace(std::move(value)); }
+
+    b8 erase(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        u32 const slot_index = as(u32, handle);
+        auto &slot = m_slots[slot_index];
+        u32 const last = as(u32, m_values.size() - 1);
+        if (slot.index != last) {
+            m_values[slot.index] = std::move(m_values[last]);
+            m_owners[slot.index] = m_owners[last];
+            m_slots[m_owners[slot.index]].index = slot.index;
+        }
+        m_values.pop_back();
+        m_owners.pop_back();
+        slot.generation++;
+        slot.index = m_free;
+        m_free = slot_index;
+        return true;
+    }
+
+    [[nodiscard]] b8 contains(SlotHandle handle) const {
+        u32 const slot_index = as(u32, handle);
+        u32 const generation = as(u32, handle >> 32);
+        return slot_index < m_slots.size() && (generation & 1) && m_slots[slot_index].generation == generation;
+    }
+
+    [[nodiscard]] T *get(SlotHandle handle) {
+        return contains(handle) ? &m_values[m_slots[as(u32, handle)].index] : nullptr;
+    }
+    [[nodiscard]] T const *get(SlotHandle handle) const {
+        return contains(handle) ? &m_values[m_slots[as(u32, handle)].index] : nullptr;
+    }
+
+    // Handle of the value stored at 'dense_index' of 'values()'
+    [[nodiscard]] SlotHandle handle_of(usize dense_index) const {
+        u32 const slot_index = m_owners[dense_index];
+        return (as(u64, m_slots[slot_index].generation) << 32) | slot_index;
+    }
+
+    void clear() {
+        while (!m_values.empty()) {
+            erase(handle_of(m_values.size() - 1));
+        }
+    }
+    void reserve(usize capacity) {
+        m_values.reserve(capacity);
+        m_owners.reserve(capacity);
+        m_slots.reserve(capacity);
+    }
+
+    [[nodiscard]] usize size() const { return m_values.size(); }
+    [[nodiscard]] b8 empty() const { return m_values.empty(); }
+
+    [[nodiscard]] Span<T> values() { return m_values; }
+    [[nodiscard]] SpanConst<T> values() const { return m_values; }
+
+    [[nodiscard]] auto begin() { return m_values.begin(); }
+    [[nodiscard]] auto end() { return m_values.end(); }
+    [[nodiscard]] auto begin() const { return m_values.begin(); }
+    [[nodiscard]] auto end() const { return m_values.end(); }
+
+private:
+    static constexpr u32 npos = u32_max;
+
+    struct Slot {
+        u32 index = npos; // Dense index when alive, next free slot otherwise
+        u32 generation = 0;
+    };
+
+    Vec<T> m_values;
+    Vec<u32> m_owners;
+    Vec<Slot> m_slots;
+    u32 m_free = npos;
+};
+
+
+// ==============================================
+// ========== Aligned Allocator
+
+template <typename T, usize Align = 64>
+class AlignedAllocator {
+public:
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(AlignedAllocator<U, Align> const &) noexcept {}
+
+    [[nodiscard]] T *allocate(usize n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(std::max(Align, alignof(T)))));
+    }
+    void deallocate(T *ptr, usize) noexcept { ::operator delete(ptr, std::align_val_t(std::max(Align, alignof(T)))); }
+
+    template <typename U>
+    [[nodiscard]] b8 operator==(AlignedAllocator<U, Align> const &) const noexcept {
+        return true;
+    }
+    template <typename U>
+    [[nodiscard]] b8 operator!=(AlignedAllocator<U, Align> const &) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, usize Align = 64>
+using AlignedVec = std::vector<T, AlignedAllocator<T, Align>>;
+
+
+// ==============================================
+// ========== Struct of Arrays
+
+// Row-oriented API over one aligned array per field. Rows are tuples of
+// references, 'field<I>()' gives the raw column for batched/SIMD code.
+template <typename... Fields>
+class SoA {
+public:
+    using Row = std::tuple<Fields &...>;
+    using RowConst = std::tuple<Fields const &...>;
+    template <usize I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template <typename Owner, typename RowT>
+    class Iterator {
+    public:
+        Iterator(Owner *owner, usize index) : m_owner(owner), m_index(index) {}
+        [[nodiscard]] RowT operator*() const { return (*m_owner)[m_index]; }
+        Iterator &operator++() {
+            ++m_index;
+            return *this;
+        }
+        [[nodiscard]] b8 operator==(Iterator const &other) const { return m_index == other.m_index; }
+        [[nodiscard]] b8 operator!=(Iterator const &other) const { return m_index != other.m_index; }
+
+    private:
+        Owner *m_owner = nullptr;
+        usize m_index = 0;
+    };
+
+    void push_back(Fields... values) { push_back_impl(Indices {}, std::move(values)...); }
+    void pop_back() {
+        for_each_column([](auto &column) { column.pop_back(); });
+    }
+    void swap_remove(usize index) {
+        for_each_column([index](auto &column) {
+            column[index] = std::move(column.back());
+            column.pop_back();
+        });
+    }
+
+    void resize(usize size) {
+        for_each_column([size](auto &column) { column.resize(size); });
+    }
+    void reserve(usize capacity) {
+        for_each_column([capacity](auto &column) { column.reserve(capacity); });
+    }
+    void clear() {
+        for_each_column([](auto &column) { column.clear(); });
+    }
+
+    [[nodiscard]] usize size() const { return std::get<0>(m_columns).size(); }
+    [[nodiscard]] b8 empty() const { return size() == 0; }
+
+    [[nodiscard]] Row operator[](usize index) { return row_impl(Indices {}, index); }
+    [[nodiscard]] RowConst operator[](usize index) const { return row_impl(Indices {}, index); }
+
+    template <usize I>
+    [[nodiscard]] Span<Field<I>> field() {
+        return std::get<I>(m_columns);
+    }
+    template <usize I>
+    [[nodiscard]] SpanConst<Field<I>> field() const {
+        return std::get<I>(m_columns);
+    }
+
+    [[nodiscard]] auto begin() { return Iterator<SoA, Row>(this, 0); }
+    [[nodiscard]] auto end() { return Iterator<SoA, Row>(this, size()); }
+    [[nodiscard]] auto begin() const { return Iterator<SoA const, RowConst>(this, 0); }
+    [[nodiscard]] auto end() const { return Iterator<SoA const, RowConst>(this, size()); }
+
+private:
+    using Indices = std::index_sequence_for<Fields...>;
+
+    template <usize... I>
+    void push_back_impl(std::index_sequence<I...>, Fields &&...values) {
+        (std::get<I>(m_columns).push_back(std::move(values)), ...);
+    }
+    template <usize... I>
+    [[nodiscard]] Row row_impl(std::index_sequence<I...>, usize index) {
+        return Row(std::get<I>(m_columns)[index]...);
+    }
+    template <usize... I>
+    [[nodiscard]] RowConst row_impl(std::index_sequence<I...>, usize index) const {
+        return RowConst(std::get<I>(m_columns)[index]...);
+    }
+    template <typename F>
+    void for_each_column(F &&fn) {
+        std::apply([&](auto &...column) { (fn(column), ...); }, m_columns);
+    }
+
+    std::tuple<AlignedVec<Fields>...> m_columns;
+};
+
+
+// ==============================================
+// ========== Thread Pool
+
+inline constexpr usize cache_line_size = 64;
+
+namespace details {
+
+struct Job {
+    virtual ~Job() = default;
+    virtual void run() = 0;
+    b8 owned = true; // Deleted by whoever runs it
+};
+
+template <typename F>
+struct FnJob final : Job {
+    explicit FnJob(F &&fn) : fn(std::move(fn)) {}
+    void run() override { fn(); }
+    F fn;
+};
+
+// First exception thrown by a group of jobs, rethrown by the thread waiting on them
+struct JobError {
+    void capture() {
+        std::lock_guard lock(mtx);
+        if (!error) {
+            error = std::current_exception();
+            failed.store(true, std::memory_order_release);
+        }
+    }
+    [[nodiscard]] std::exception_ptr take() {
+        if (!failed.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        std::lock_guard lock(mtx);
+        failed.store(false, std::memory_order_relaxed);
+        return std::exchange(error, nullptr);
+    }
+    void rethrow() {
+        if (std::exception_ptr taken = take()) {
+            std::rethrow_exception(taken);
+        }
+    }
+    std::atomic<b8> failed = false;
+    std::mutex mtx;
+    std::exception_ptr error = nullptr;
+};
+
+// Chase-Lev deque: the owner pushes and pops at the bottom, thieves steal from the top
+class WorkDeque {
+    bee_nocopy_nomove(WorkDeque);
+
+public:
+    explicit WorkDeque(i64 capacity = 1024);
+
+    void push(Job *job);
+    [[nodiscard]] Job *pop();
+    [[nodiscard]] Job *steal();
+
+private:
+    struct Ring {
+        explicit Ring(i64 capacity) : capacity(capacity), items(new std::atomic<Job *>[capacity]) {}
+        [[nodiscard]] Job *get(i64 i) const { return items[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(i64 i, Job *job) { items[i & (capacity - 1)].store(job, std::memory_order_relaxed); }
+        i64 capacity = 0;
+        Uptr<std::atomic<Job *>[]> items;
+    };
+
+    alignas(cache_line_size) std::atomic<i64> m_top = 0;
+    alignas(cache_line_size) std::atomic<i64> m_bottom = 0;
+    alignas(cache_line_size) std::atomic<Ring *> m_ring = nullptr;
+    Vec<Uptr<Ring>> m_rings; // Old rings stay alive, a thief could still be reading them
+};
+
+} // namespace details
+
+// Work-stealing pool. Waiting from inside the pool ('wait', 'wait_until',
+// 'parallel_for') runs pending jobs instead of blocking, so nesting is safe.
+// 'parallel_for' rethrows the first exception of its chunks once all of them
+// ran. 'submit' futures carry their own exception, the first one escaping a
+// fire and forget 'spawn' job is kept until 'take_error' collects it.
+class ThreadPool {
+    bee_nocopy_nomove(ThreadPool);
+
+public:
+    explicit ThreadPool(usize threads = 0); // 0 => hardware concurrency
+    ~ThreadPool();
+
+    [[nodiscard]] usize size() const;
+
+    // Fire and forget
+    template <typename F>
+    void spawn(F &&fn) {
+        auto guarded = [this, fn = std::forward<F>(fn)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                m_error.capture();
+            }
+        };
+        push(new details::FnJob<decltype(guarded)>(std::move(guarded)));
+    }
+
+    template <typename F>
+    [[nodiscard]] auto submit(F &&fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        std::packaged_task<R()> task(std::forward<F>(fn));
+        auto future = task.get_future();
+        spawn([task = std::move(task)]() mutable { task(); });
+        return future;
+    }
+
+    // Runs one pending job on the calling thread, false if there was none
+    b8 run_one();
+
+    template <typename Pred>
+    void wait_until(Pred &&done) {
+        while (!done()) {
+            if (!run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // First exception escaping a 'spawn' job since the last call, null if none
+    [[nodiscard]] std::exception_ptr take_error() { return m_error.take(); }
+
+    template <typename R>
+    R wait(std::future<R> &future) {
+        wait_until([&] { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+        return future.get();
+    }
+
+    // 'fn(i)' for every i in [begin, end), a 'grain' of 0 picks one from the pool size
+    template <typename F>
+    void parallel_for(usize begin, usize end, F &&fn, usize grain = 0) {
+        if (end <= begin) {
+            return;
+        }
+        usize const count = end - begin;
+        grain = grain > 0 ? grain : grain_for(count);
+        usize const chunks = (count + grain - 1) / grain;
+        if (chunks < 2) {
+            for (usize i = begin; i < end; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<usize> remaining = chunks - 1;
+        details::JobError error;
+        struct Chunk final : details::Job {
+            Chunk(F &fn, std::atomic<usize> &remaining, details::JobError &error, usize begin, usize end)
+                : fn(fn), remaining(remaining), error(error), begin(begin), end(end) {
+                owned = false;
+            }
+            void run() override {
+                try {
+                    for (usize i = begin; i < end; ++i) {
+                        fn(i);
+                    }
+                } catch (...) {
+                    error.capture();
+                }
+                remaining.fetch_sub(1, std::memory_order_release);
+            }
+            F &fn;
+            std::atomic<usize> &remaining;
+            details::JobError &error;
+            usize begin = 0;
+            usize end = 0;
+        };
+
+        // Jobs live in this frame, it can't return before all of them ran
+        Vec<Chunk> jobs;
+        jobs.reserve(chunks - 1);
+        for (usize c = 1; c < chunks; ++c) {
+            jobs.emplace_back(fn, remaining, error, begin + c * grain, std::min(end, begin + (c + 1) * grain));
+            push(&jobs.back(), false);
+        }
+        wake_all();
+
+        try {
+            for (usize i = begin; i < begin + grain; ++i) {
+                fn(i);
+            }
+        } catch (...) {
+            error.capture();
+        }
+        wait_until([&] { return remaining.load(std::memory_order_acquire) == 0; });
+        error.rethrow();
+    }
+
+    template <typename Container, typename F>
+    void parallel_for_each(Container &&items, F &&fn, usize grain = 0) {
+        auto *data = std::data(items);
+        parallel_for(0, std::size(items), [&](usize i) { fn(data[i]); }, grain);
+    }
+
+    [[nodiscard]] usize grain_for(usize count) const;
+
+private:
+    friend class TaskGraph;
+
+    void push(details::Job *job, b8 wake = true);
+    void wake_all();
+    void execute(details::Job *job);
+    [[nodiscard]] details::Job *find_job();
+    void worker_main(usize index);
+
+    Vec<std::thread> m_threads;
+    Vec<Uptr<details::WorkDeque>> m_deques;
+
+    std::mutex m_injected_mtx;
+    std::deque<details::Job *> m_injected;
+
+    alignas(cache_line_size) std::atomic<i64> m_queued = 0;
+    alignas(cache_line_size) std::atomic<i64> m_sleeping = 0;
+    std::mutex m_sleep_mtx;
+    std::condition_variable m_sleep_cv;
+    b8 m_stop = false;
+
+    details::JobError m_error; // From 'spawn' jobs
+};
+
+// Process-wide pool, created on first use
+[[nodiscard]] ThreadPool &thread_pool();
+
+template <typename F>
+void parallel_for(usize begin, usize end, F &&fn, usize grain = 0) {
+    thread_pool().parallel_for(begin, end, std::forward<F>(fn), grain);
+}
+template <typename Container, typename F>
+void parallel_for_each(Container &&items, F &&fn, usize grain = 0) {
+    thread_pool().parallel_for_each(std::forward<Container>(items), std::forward<F>(fn), grain);
+}
+
+
+// ==============================================
+// ========== Parallel Algorithms
+
+// Drop-in parallel versions of common algorithms, inputs are any contiguous
+// range (Span, Vec, Arr). Below 'serial_threshold' items they run serially.
+namespace par {
+
+inline constexpr usize serial_threshold = 1 << 14;
+
+template <typename Range, typename F>
+void for_each(Range &&items, F &&fn, ThreadPool &pool = thread_pool()) {
+    if (std::size(items) < serial_threshold) {
+        std::for_each(std::begin(items), std::end(items), fn);
+        return;
+    }
+    pool.parallel_for_each(items, fn);
+}
+
+template <typename In, typename Out, typename F>
+void transform(In const &input, Out &&output, F &&fn, ThreadPool &pool = thread_pool()) {
+    usize const count = std::min(std::size(input), std::size(output));
+    auto *src = std::data(input);
+    auto *dst = std::data(output);
+    if (count < serial_threshold) {
+        std::transform(src, src + count, dst, fn);
+        return;
+    }
+    pool.parallel_for(0, count, [&](usize i) { dst[i] = fn(src[i]); });
+}
+
+// Fixed-size blocks combined in order: the result does not depend on the pool
+// size or the scheduling, so it is deterministic for floats too
+template <typename Range, typename T, typename Op = std::plus<>>
+[[nodiscard]] T reduce(Range const &items, T init, Op op = {}, ThreadPool &pool = thread_pool()) {
+    usize const count = std::size(items);
+    auto *data = std::data(items);
+    usize const blocks = (count + serial_threshold - 1) / serial_threshold;
+    if (blocks < 2) {
+        return std::accumulate(data, data + count, init, op);
+    }
+    Vec<Opt<T>> partials(blocks);
+    pool.parallel_for(
+      0, blocks,
+      [&](usize b) {
+          usize const begin = b * serial_threshold;
+          usize const end = std::min(count, begin + serial_threshold);
+          T acc = data[begin];
+          for (usize i = begin + 1; i < end; ++i) {
+              acc = op(std::move(acc), data[i]);
+          }
+          partials[b] = std::move(acc);
+      },
+      1);
+    for (auto &partial : partials) {
+        init = op(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+template <typename In, typename Out, typename Op = std::plus<>>
+void inclusive_scan(In const &input, Out &&output, Op op = {}, ThreadPool &pool = thread_pool()) {
+    usize const count = std::min(std::size(input), std::size(output));
+    auto *src = std::data(input);
+    auto *dst = std::data(output);
+    usize const blocks = (count + serial_threshold - 1) / serial_threshold;
+    if (blocks < 2) {
+        std::inclusive_scan(src, src + count, dst, op);
+        return;
+    }
+    auto const block_range = [count](usize b) {
+        usize const begin = b * serial_threshold;
+        return std::pair { begin, std::min(count, begin + serial_threshold) };
+    };
+
+    // Local scans, then carry each block's total into the following ones
+    pool.parallel_for(
+      0, blocks,
+      [&](usize b) {
+          auto const [begin, end] = block_range(b);
+          std::inclusive_scan(src + begin, src + end, dst + begin, op);
+      },
+      1);
+    using T = std::remove_reference_t<decltype(*dst)>;
+    Vec<T> carries;
+    carries.reserve(blocks);
+    carries.push_back(dst[block_range(0).second - 1]);
+    for (usize b = 1; b < blocks - 1; ++b) {
+        carries.push_back(op(carries.back(), dst[block_range(b).second - 1]));
+    }
+    pool.parallel_for(
+      1, blocks,
+      [&](usize b) {
+          auto const [begin, end] = block_range(b);
+          for (usize i = begin; i < end; ++i) {
+              dst[i] = op(carries[b - 1], dst[i]);
+          }
+      },
+      1);
+}
+
+// Sorts one chunk per thread, then merges chunks pairwise in parallel rounds.
+// Needs a default constructible value type for the merge buffer.
+template <typename Range, typename Cmp = std::less<>>
+void sort(Range &&items, Cmp cmp = {}, ThreadPool &pool = thread_pool()) {
+    usize const count = std::size(items);
+    auto *data = std::data(items);
+    usize const chunks = std::min(pool.size() + 1, count / serial_threshold);
+    if (chunks < 2) {
+        std::sort(data, data + count, cmp);
+        return;
+    }
+
+    Vec<usize> bounds(chunks + 1);
+    for (usize c = 0; c <= chunks; ++c) {
+        bounds[c] = c * count / chunks;
+    }
+    pool.parallel_for(0, chunks, [&](usize c) { std::sort(data + bounds[c], data + bounds[c + 1], cmp); }, 1);
+
+    using T = std::remove_reference_t<decltype(*data)>;
+    Vec<T> buffer(count);
+    T *src = data;
+    T *dst = buffer.data();
+    for (usize width = 1; width < chunks; width *= 2) {
+        usize const pairs = (chunks + 2 * width - 1) / (2 * width);
+        pool.parallel_for(
+          0, pairs,
+          [&](usize p) {
+              usize const lo = bounds[p * 2 * width];
+              usize const mid = bounds[std::min(p * 2 * width + width, chunks)];
+              usize const hi = bounds[std::min(p * 2 * width + 2 * width, chunks)];
+              std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                         std::make_move_iterator(src + mid), std::make_move_iterator(src + hi), dst + lo, cmp);
+          },
+          1);
+        std::swap(src, dst);
+    }
+    if (src != data) {
+        pool.parallel_for(0, count, [&](usize i) { data[i] = std::move(src[i]); });
+    }
+}
+
+} // namespace par
+
+
+// ==============================================
+// ========== Task Graph
+
+// Declare nodes and edges once, run as many times as needed. Ready nodes with
+// the longest remaining path (weighted by last run timings) go first. 'run'
+// rethrows the first exception of a node once the nodes in flight finished,
+// nodes that were not started yet are skipped.
+class TaskGraph {
+    bee_nocopy_nomove(TaskGraph);
+
+public:
+    using NodeId = u32;
+
+    TaskGraph() = default;
+
+    NodeId add(Str name, Fn<void()> fn);
+    void precede(NodeId before, NodeId after);
+
+    // False if the graph has a cycle
+    b8 run(ThreadPool &pool = thread_pool());
+
+    [[nodiscard]] usize size() const;
+    [[nodiscard]] Str const &name(NodeId node) const;
+
+    // Timings from the last run
+    [[nodiscard]] f64 elapsed_ms() const;
+    [[nodiscard]] f64 elapsed_ms(NodeId node) const;
+    [[nodiscard]] Vec<NodeId> critical_path() const;
+
+private:
+    static constexpr NodeId npos = u32_max;
+
+    struct Node {
+        Str name;
+        Fn<void()> fn;
+        Vec<NodeId> successors; // Sorted by priority, highest first
+        u32 predecessors = 0;
+        f64 priority = 0.;
+        f64 elapsed_ns = 0.;
+    };
+
+    struct NodeJob final : details::Job {
+        NodeJob(TaskGraph *graph, NodeId node) : graph(graph), node(node) { owned = false; }
+        void run() override { graph->execute(node, *pool); }
+        TaskGraph *graph = nullptr;
+        ThreadPool *pool = nullptr;
+        NodeId node = npos;
+    };
+
+    b8 prepare();
+    void prioritize();
+    void execute(NodeId node, ThreadPool &pool);
+
+    Vec<Node> m_nodes;
+    Vec<NodeId> m_order; // Topological
+    Vec<NodeId> m_roots; // Sorted by priority, highest first
+    Vec<NodeJob> m_jobs;
+    Uptr<std::atomic<u32>[]> m_pending;
+    std::atomic<u32> m_remaining = 0;
+    details::JobError m_error;
+    f64 m_elapsed_ns = 0.;
+    b8 m_dirty = true;
+};
+
+
+// ==============================================
+// ========== Coroutines
+
+#ifdef BEE_HAS_COROUTINES
+
+template <typename T = void>
+class Task;
+
+namespace details {
+
+struct TaskPromiseBase {
+    // Symmetric transfer back to whoever awaited us
+    struct FinalAwaiter {
+        [[nodiscard]] b8 await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+            auto const continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+    [[nodiscard]] FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+    void rethrow() const {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::coroutine_handle<> continuation = nullptr;
+    std::exception_ptr exception = nullptr;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    [[nodiscard]] Task<T> get_return_object() noexcept;
+    template <typename U>
+    void return_value(U &&value) {
+        result.emplace(std::forward<U>(value));
+    }
+    [[nodiscard]] T take() {
+        rethrow();
+        return std::move(*result);
+    }
+    Opt<T> result;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    [[nodiscard]] Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void take() const { rethrow(); }
+};
+
+// Coroutine that starts eagerly and frees itself when done
+struct Detached {
+    struct promise_type {
+        [[nodiscard]] Detached get_return_object() const noexcept { return {}; }
+        [[nodiscard]] std::suspend_never initial_suspend() const noexcept { return {}; }
+        [[nodiscard]] std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+struct WaitGroup {
+    void done() {
+        std::lock_guard lock(mtx);
+        if (--count == 0) {
+            cv.notify_all();
+        }
+    }
+    void wait() {
+        std::unique_lock lock(mtx);
+        cv.wait(lock, [this] { return count == 0; });
+    }
+    std::mutex mtx;
+    std::condition_variable cv;
+    usize count = 0;
+};
+
+template <typename T>
+using TaskResult = std::conditional_t<std::is_void_v<T>, b8, T>;
+
+// Never lets an exception reach 'Detached', the waiting thread rethrows 'error'
+template <typename T>
+Detached sync_drive(Task<T> task, Opt<TaskResult<T>> &out, std::exception_ptr &error, WaitGroup &group) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            out.emplace(true);
+        } else {
+            out.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    group.done();
+}
+
+} // namespace details
+
+// Lazy coroutine, starts when awaited and resumes its awaiter by symmetric transfer
+template <typename T>
+class Task {
+public:
+    using promise_type = details::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle handle) noexcept : m_handle(handle) {}
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task &operator=(Task &&other) noexcept {
+        std::swap(m_handle, other.m_handle);
+        return *this;
+    }
+    Task(Task const &) = delete;
+    Task &operator=(Task const &) = delete;
+    ~Task() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    [[nodiscard]] b8 done() const noexcept { return !m_handle || m_handle.done(); }
+
+    [[nodiscard]] auto operator co_await() noexcept {
+        struct Awaiter {
+            [[nodiscard]] b8 await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+            Handle handle;
+        };
+        return Awaiter { m_handle };
+    }
+
+private:
+    Handle m_handle = nullptr;
+};
+
+template <typename T>
+Task<T> details::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+inline Task<void> details::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// 'co_await resume_on(pool)' continues the coroutine on a pool worker
+[[nodiscard]] inline auto resume_on(ThreadPool &pool) noexcept {
+    struct Awaiter {
+        [[nodiscard]] b8 await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { pool.spawn([handle] { handle.resume(); }); }
+        void await_resume() const noexcept {}
+        ThreadPool &pool;
+    };
+    return Awaiter { pool };
+}
+
+// 'co_await offload(fn, pool)' runs a blocking call on a pool worker and continues there
+template <typename F>
+[[nodiscard]] auto offload(F fn, ThreadPool &pool = thread_pool()) {
+    using R = std::invoke_result_t<F>;
+    static_assert(!std::is_void_v<R>, "[bee] :: 'offload' needs a callable that returns a value");
+    struct Awaiter {
+        [[nodiscard]] b8 await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.spawn([this, handle] {
+                try {
+                    result.emplace(fn());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                handle.resume();
+            });
+        }
+        [[nodiscard]] R await_resume() {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return std::move(*result);
+        }
+        F fn;
+        ThreadPool &pool;
+        Opt<R> result = std::nullopt;
+        std::exception_ptr error = nullptr;
+    };
+    return Awaiter { std::move(fn), pool };
+}
+
+// Blocks the calling thread, never call these from inside a pool job. An
+// exception thrown by a task is rethrown here, 'sync_wait_all' rethrows the
+// first one after every task finished.
+template <typename T>
+details::TaskResult<T> sync_wait(Task<T> task) {
+    details::WaitGroup group;
+    group.count = 1;
+    Opt<details::TaskResult<T>> result;
+    std::exception_ptr error = nullptr;
+    details::sync_drive(std::move(task), result, error, group);
+    group.wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return std::move(*result);
+}
+template <typename T>
+Vec<details::TaskResult<T>> sync_wait_all(Vec<Task<T>> tasks) {
+    details::WaitGroup group;
+    group.count = tasks.size();
+    Vec<Opt<details::TaskResult<T>>> slots(tasks.size());
+    Vec<std::exception_ptr> errors(tasks.size());
+    for (usize i = 0; i < tasks.size(); ++i) {
+        details::sync_drive(std::move(tasks[i]), slots[i], errors[i], group);
+    }
+    group.wait();
+    for (auto const &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    Vec<details::TaskResult<T>> results;
+    results.reserve(slots.size());
+    for (auto &slot : slots) {
+        results.push_back(std::move(*slot));
+    }
+    return results;
+}
+
+// Awaitable file helpers, the blocking call runs on 'pool'
+[[nodiscard]] Task<Str> file_read_async(Str input_file, ThreadPool &pool = thread_pool());
+[[nodiscard]] Task<Vec<u8>> bin_read_async(Str path, ThreadPool &pool = thread_pool());
+[[nodiscard]] Task<b8> file_write_append_async(Str output_file, Str to_write, ThreadPool &pool = thread_pool());
+[[nodiscard]] Task<b8> file_write_trunc_async(Str output_file, Str to_write, ThreadPool &pool = thread_pool());
+
+#endif // BEE_HAS_COROUTINES
+
+
+// ==============================================
+// ========== Synchronization
+
+// Hints the CPU that we are busy-waiting (x86 'pause', arm 'yield')
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Exponential spin with 'cpu_relax', falls back to yielding the thread
+class Backoff {
+public:
+    void pause() {
+        if (m_step < spin_steps) {
+            for (u32 i = 0; i < (1u << m_step); ++i) {
+                cpu_relax();
+            }
+            ++m_step;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    void reset() { m_step = 0; }
+
+private:
+    static constexpr u32 spin_steps = 6;
+    u32 m_step = 0;
+};
+
+// Test-and-test-and-set lock, for critical sections of a handful of instructions
+class Spinlock {
+    bee_nocopy_nomove(Spinlock);
+
+public:
+    Spinlock() = default;
+
+    void lock() {
+        Backoff backoff;
+        while (m_locked.exchange(true, std::memory_order_acquire)) {
+            while (m_locked.load(std::memory_order_relaxed)) { // Spin on a shared line, not on a RMW
+                backoff.pause();
+            }
+        }
+    }
+    [[nodiscard]] b8 try_lock() {
+        return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() { m_locked.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<b8> m_locked = false;
+};
+
+// Futex based mutex (3 states: free, locked, locked with waiters).
+// Uncontended lock/unlock is a single atomic op, no syscall.
+class Mutex {
+    bee_nocopy_nomove(Mutex);
+
+public:
+    Mutex() = default;
+
+    void lock() {
+        u32 state = 0;
+        if (!m_state.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            lock_slow(state);
+        }
+    }
+    [[nodiscard]] b8 try_lock() {
+        u32 state = 0;
+        return m_state.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    void unlock() {
+        if (m_state.exchange(0, std::memory_order_release) == 2) {
+            wake_one();
+        }
+    }
+
+private:
+    void lock_slow(u32 state);
+    void wake_one();
+
+    std::atomic<u32> m_state = 0;
+};
+
+// Read-mostly value for trivially copyable types, readers never block writers
+// and retry if a write happened while they were copying
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock needs a trivially copyable type");
+    bee_nocopy_nomove(SeqLock);
+
+public:
+    SeqLock() = default;
+    explicit SeqLock(T const &value) { store_words(value); }
+
+    void store(T const &value) {
+        m_writer.lock();
+        u32 const sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store_words(value);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+        m_writer.unlock();
+    }
+
+    [[nodiscard]] T load() const {
+        Backoff backoff;
+        while (true) {
+            u32 const before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                T value = load_words();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    return value;
+                }
+            }
+            backoff.pause();
+        }
+    }
+
+private:
+    // The payload lives in relaxed atomic words, so a torn read is a retry and not a data race
+    static constexpr usize word_count = (sizeof(T) + sizeof(usize) - 1) / sizeof(usize);
+
+    void store_words(T const &value) {
+        Arr<usize, word_count> words {};
+        std::memcpy(words.data(), &value, sizeof(T));
+        for (usize i = 0; i < word_count; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+    [[nodiscard]] T load_words() const {
+        Arr<usize, word_count> words;
+        for (usize i = 0; i < word_count; ++i) {
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+    std::atomic<u32> m_sequence = 0;
+    Spinlock m_writer;
+    std::atomic<usize> m_words[word_count] {};
+};
+
+// Keeps 'T' on its own cache line(s) so neighbours don't false-share it
+template <typename T>
+struct alignas(cache_line_size) Padded {
+    Padded() = default;
+    template <typename... Args>
+    explicit Padded(Args &&...args) : value(std::forward<Args>(args)...) {}
+
+    T *operator->() { return &value; }
+    T const *operator->() const { return &value; }
+    T &operator*() { return value; }
+    T const &operator*() const { return value; }
+
+    T value {};
+};
+
+
+// ==============================================
+// ========== Lock-free Queues
+
+namespace details {
+
+template <typename T>
+struct QueueSlot {
+    [[nodiscard]] T *get() noexcept { return std::launder(recast(T *, storage)); }
+    alignas(T) std::byte storage[sizeof(T)];
+};
+
+inline usize queue_capacity(usize capacity) {
+    usize pow2 = 2;
+    while (pow2 < capacity) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+} // namespace details
+
+// Single producer / single consumer ring. Each side keeps a cached copy of the
+// other side's index and only reloads it when the ring looks full / empty.
+template <typename T>
+class SpscQueue {
+    bee_nocopy_nomove(SpscQueue);
+
+public:
+    explicit SpscQueue(usize capacity)
+        : m_mask(details::queue_capacity(capacity) - 1), m_slots(new details::QueueSlot<T>[m_mask + 1]) {}
+    ~SpscQueue() {
+        for (usize i = m_head.load(); i != m_tail.load(); ++i) {
+            m_slots[i & m_mask].get()->~T();
+        }
+    }
+
+    template <typename U>
+    [[nodiscard]] b8 try_push(U &&value) {
+        usize const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cached > m_mask) {
+            m_head_cached = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cached > m_mask) {
+                return false;
+            }
+        }
+        new (m_slots[tail & m_mask].get()) T(std::forward<U>(value));
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] b8 try_pop(T &out) {
+        usize const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cached) {
+            m_tail_cached = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cached) {
+                return false;
+            }
+        }
+        T *item = m_slots[head & m_mask].get();
+        out = std::move(*item);
+        item->~T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves as many items as fit with a single index publish, returns the count
+    usize try_push_batch(Span<T> items) {
+        usize const tail = m_tail.load(std::memory_order_relaxed);
+        m_head_cached = m_head.load(std::memory_order_acquire);
+        usize const count = std::min(items.size(), m_mask + 1 - (tail - m_head_cached));
+        for (usize i = 0; i < count; ++i) {
+            new (m_slots[(tail + i) & m_mask].get()) T(std::move(items[i]));
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    usize try_pop_batch(Span<T> out) {
+        usize const head = m_head.load(std::memory_order_relaxed);
+        m_tail_cached = m_tail.load(std::memory_order_acquire);
+        usize const count = std::min(out.size(), m_tail_cached - head);
+        for (usize i = 0; i < count; ++i) {
+            T *item = m_slots[(head + i) & m_mask].get();
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    template <typename U>
+    void push(U &&value) {
+        Backoff backoff;
+        while (!try_push(std::forward<U>(value))) { // Only moved from on success
+            backoff.pause();
+        }
+    }
+    [[nodiscard]] T pop() {
+        T out;
+        Backoff backoff;
+        while (!try_pop(out)) {
+            backoff.pause();
+        }
+        return out;
+    }
+
+    [[nodiscard]] usize capacity() const { return m_mask + 1; }
+    [[nodiscard]] usize size_approx() const {
+        return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(cache_line_size) std::atomic<usize> m_head = 0; // Written by the consumer
+    usize m_tail_cached = 0;
+    alignas(cache_line_size) std::atomic<usize> m_tail = 0; // Written by the producer
+    usize m_head_cached = 0;
+    alignas(cache_line_size) usize const m_mask;
+    Uptr<details::QueueSlot<T>[]> m_slots;
+};
+
+// Bounded multi producer / multi consumer queue (Dmitry Vyukov's design):
+// every cell carries a sequence number telling whose turn it is
+template <typename T>
+class MpmcQueue {
+    bee_nocopy_nomove(MpmcQueue);
+
+public:
+    explicit MpmcQueue(usize capacity)
+        : m_mask(details::queue_capacity(capacity) - 1), m_cells(new Cell[m_mask + 1]) {
+        for (usize i = 0; i <= m_mask; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~MpmcQueue() {
+        for (usize i = m_dequeue.load(); i != m_enqueue.load(); ++i) {
+            m_cells[i & m_mask].slot.get()->~T();
+        }
+    }
+
+    template <typename U>
+    [[nodiscard]] b8 try_push(U &&value) {
+        usize pos = m_enqueue.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            usize const sequence = cell->sequence.load(std::memory_order_acquire);
+            isize const diff = as(isize, sequence) - as(isize, pos);
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->slot.get()) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] b8 try_pop(T &out) {
+        usize pos = m_dequeue.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            usize const sequence = cell->sequence.load(std::memory_order_acquire);
+            isize const diff = as(isize, sequence) - as(isize, pos + 1);
+            if (diff == 0) {
+                if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+        T *item = cell->slot.get();
+        out = std::move(*item);
+        item->~T();
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    usize try_push_batch(Span<T> items) {
+        usize count = 0;
+        while (count < items.size() && try_push(std::move(items[count]))) {
+            ++count;
+        }
+        return count;
+    }
+    usize try_pop_batch(Span<T> out) {
+        usize count = 0;
+        while (count < out.size() && try_pop(out[count])) {
+            ++count;
+        }
+        return count;
+    }
+
+    template <typename U>
+    void push(U &&value) {
+        Backoff backoff;
+        while (!try_push(std::forward<U>(value))) { // Only moved from on success
+            backoff.pause();
+        }
+    }
+    [[nodiscard]] T pop() {
+        T out;
+        Backoff backoff;
+        while (!try_pop(out)) {
+            backoff.pause();
+        }
+        return out;
+    }
+
+    [[nodiscard]] usize capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<usize> sequence = 0;
+        details::QueueSlot<T> slot;
+    };
+
+    alignas(cache_line_size) std::atomic<usize> m_enqueue = 0;
+    alignas(cache_line_size) std::atomic<usize> m_dequeue = 0;
+    alignas(cache_line_size) usize const m_mask;
+    Uptr<Cell[]> m_cells;
+};
+
+
+// ==============================================
+// ========== Snapshots
+
+// One writer hands whole states to one reader through three buffers: the
+// writer fills its back buffer and swaps it with the middle one, the reader
+// swaps the middle one into its front buffer when there is something new.
+// Neither side ever waits or copies.
+template <typename T>
+class TripleBuffer {
+    bee_nocopy_nomove(TripleBuffer);
+
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(T const &value) : m_buffers { Padded<T>(value), Padded<T>(value), Padded<T>(value) } {}
+
+    // Writer side
+    [[nodiscard]] T &write_buffer() { return *m_buffers[m_back]; }
+    void publish() { m_back = m_middle.exchange(m_back | fresh_bit, std::memory_order_acq_rel) & index_mask; }
+    template <typename U>
+    void publish(U &&value) {
+        write_buffer() = std::forward<U>(value);
+        publish();
+    }
+
+    // Reader side, 'update' returns false when nothing new was published
+    b8 update() {
+        if ((m_middle.load(std::memory_order_relaxed) & fresh_bit) == 0) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+    [[nodiscard]] T const &read() const { return *m_buffers[m_front]; }
+    [[nodiscard]] T const &latest() {
+        update();
+        return read();
+    }
+
+private:
+    static constexpr u8 index_mask = 0b011;
+    static constexpr u8 fresh_bit = 0b100;
+
+    Arr<Padded<T>, 3> m_buffers {};
+    alignas(cache_line_size) u8 m_back = 0;
+    alignas(cache_line_size) std::atomic<u8> m_middle = 1;
+    alignas(cache_line_size) u8 m_front = 2;
+};
+
+// Latest-value cell for one writer and many readers. Readers pin the current
+// snapshot through a hazard pointer slot, so they read it in place without
+// locks; the writer swaps pointers and only frees snapshots no slot protects.
+template <typename T, usize Readers = 32>
+class LatestCell {
+    bee_nocopy_nomove(LatestCell);
+
+    struct Slot {
+        std::atomic<b8> used = false;
+        std::atomic<T const *> hazard = nullptr;
+    };
+
+public:
+    class Guard {
+        bee_nocopy(Guard);
+
+    public:
+        Guard(Guard &&other) noexcept
+            : m_slot(std::exchange(other.m_slot, nullptr)), m_value(std::exchange(other.m_value, nullptr)) {}
+        Guard &operator=(Guard &&) = delete;
+        ~Guard() {
+            if (m_slot) {
+                m_slot->hazard.store(nullptr, std::memory_order_release);
+                m_slot->used.store(false, std::memory_order_release);
+            }
+        }
+
+        [[nodiscard]] T const &operator*() const { return *m_value; }
+        [[nodiscard]] T const *operator->() const { return m_value; }
+        [[nodiscard]] T const *get() const { return m_value; }
+
+    private:
+        friend class LatestCell;
+        Guard(Slot *slot, T const *value) : m_slot(slot), m_value(value) {}
+
+        Slot *m_slot;
+        T const *m_value;
+    };
+
+    LatestCell() : m_current(new T {}) {}
+    explicit LatestCell(T value) : m_current(new T(std::move(value))) {}
+    ~LatestCell() {
+        delete m_current.load();
+        for (T const *retired : m_retired) {
+            delete retired;
+        }
+    }
+
+    // Writer side, never waits for readers
+    template <typename... Args>
+    void emplace(Args &&...args) {
+        T const *previous = m_current.exchange(new T(std::forward<Args>(args)...), std::memory_order_seq_cst);
+        m_retired.push_back(previous);
+        if (m_retired.size() >= reclaim_batch) {
+            reclaim();
+        }
+    }
+    void publish(T value) { emplace(std::move(value)); }
+
+    // Reader side, the snapshot stays valid while the guard lives
+    [[nodiscard]] Guard read() const {
+        Slot *slot = acquire_slot();
+        T const *value = m_current.load(std::memory_order_seq_cst);
+        while (true) {
+            slot->hazard.store(value, std::memory_order_seq_cst);
+            T const *const again = m_current.load(std::memory_order_seq_cst);
+            if (again == value) {
+                return Guard(slot, value);
+            }
+            value = again;
+        }
+    }
+
+    [[nodiscard]] usize retired() const { return m_retired.size(); }
+
+private:
+    static constexpr usize reclaim_batch = Readers + 8;
+
+    Slot *acquire_slot() const {
+        usize index = std::hash<std::thread::id> {}(std::this_thread::get_id());
+        Backoff backoff;
+        while (true) {
+            for (usize i = 0; i < Readers; ++i, ++index) {
+                Slot &slot = *m_slots[index % Readers];
+                if (!slot.used.load(std::memory_order_relaxed) &&
+                    !slot.used.exchange(true, std::memory_order_acquire)) {
+                    return &slot;
+                }
+            }
+            backoff.pause(); // More concurrent readers than slots
+        }
+    }
+
+    void reclaim() {
+        Arr<T const *, Readers> hazards;
+        for (usize i = 0; i < Readers; ++i) {
+            hazards[i] = m_slots[i]->hazard.load(std::memory_order_seq_cst);
+        }
+        std::sort(hazards.begin(), hazards.end());
+        auto const alive = std::partition(m_retired.begin(), m_retired.end(), [&](T const *retired) {
+            return std::binary_search(hazards.begin(), hazards.end(), retired);
+        });
+        for (auto it = alive; it != m_retired.end(); ++it) {
+            delete *it;
+        }
+        m_retired.erase(alive, m_retired.end());
+    }
+
+    std::atomic<T const *> m_current;
+    mutable Arr<Padded<Slot>, Readers> m_slots {};
+    Vec<T const *> m_retired;
+};
+
+
+// ==============================================
+// ========== LRU Cache
+
+namespace details {
+
+// Default cost of a cache entry: the object plus what a container owns on the heap
+template <typename T>
+[[nodiscard]] usize cache_bytes(T const &value) {
+    if constexpr (requires {
+                      value.size();
+                      typename T::value_type;
+                  }) {
+        return sizeof(T) + value.size() * sizeof(typename T::value_type);
+    } else {
+        return sizeof(T);
+    }
+}
+
+} // namespace details
+
+struct CacheStats {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 inserts = 0;
+    u64 evictions = 0;
+};
+
+// Least recently used cache bounded by bytes, split in lock-striped shards
+// (each owning capacity / Shards bytes) so threads hitting different keys do
+// not serialize on a single mutex. Lookups accept any type the hasher and
+// std::equal_to<> accept, e.g. a string_view for Str keys.
+template <typename K, typename V, typename Hash = Hasher, usize Shards = 16>
+class LruCache {
+    static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+    bee_nocopy_nomove(LruCache);
+
+public:
+    explicit LruCache(usize capacity_bytes) : m_capacity(capacity_bytes) {}
+
+    template <typename Q>
+    [[nodiscard]] Opt<V> get(Q const &key) {
+        Shard &shard = shard_of(key);
+        bee_lock(shard.mtx);
+        auto const it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            ++shard.stats.misses;
+            return {};
+        }
+        ++shard.stats.hits;
+        shard.touch(&it->second);
+        return it->second.value;
+    }
+
+    template <typename Q>
+    [[nodiscard]] b8 contains(Q const &key) const {
+        Shard &shard = shard_of(key);
+        bee_lock(shard.mtx);
+        return shard.map.find(key) != shard.map.end();
+    }
+
+    // Inserts or replaces, returns false if the entry alone exceeds a shard's budget
+    // (an older value under that key is dropped too, it would be stale).
+    // The key is only converted to 'K' when it is not cached yet.
+    template <typename Q>
+    b8 put(Q &&key, V value) {
+        usize const cost = details::cache_bytes(key) + details::cache_bytes(value);
+        return put(std::forward<Q>(key), std::move(value), cost);
+    }
+    template <typename Q>
+    b8 put(Q &&key, V value, usize cost) {
+        Shard &shard = shard_of(key);
+        bee_lock(shard.mtx);
+        auto it = shard.map.find(key);
+        if (cost > shard_capacity()) {
+            if (it != shard.map.end()) {
+                shard.unlink(&it->second);
+                shard.bytes -= it->second.cost;
+                shard.map.erase(it);
+            }
+            return false;
+        }
+        if (it == shard.map.end()) {
+            it = shard.map.try_emplace(K(std::forward<Q>(key))).first;
+            it->second.key = &it->first;
+            shard.push_front(&it->second);
+        } else {
+            shard.bytes -= it->second.cost;
+            shard.touch(&it->second);
+        }
+        Entry &entry = it->second;
+        entry.value = std::move(value);
+        entry.cost = cost;
+        shard.bytes += cost;
+        ++shard.stats.inserts;
+        shard.evict(shard_capacity());
+        return true;
+    }
+
+    // Returns the cached value or stores the result of 'make()', which runs outside the lock
+    template <typename Q, typename F>
+    V get_or(Q const &key, F &&make) {
+        if (Opt<V> cached = get(key)) {
+            return std::move(*cached);
+        }
+        V value = make();
+        put(key, value);
+        return value;
+    }
+
+    template <typename Q>
+    b8 erase(Q const &key) {
+        Shard &shard = shard_of(key);
+        bee_lock(shard.mtx);
+        auto const it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        shard.unlink(&it->second);
+        shard.bytes -= it->second.cost;
+        shard.map.erase(it);
+        return true;
+    }
+
+    void clear() {
+        for (auto &shard : m_shards) {
+            bee_lock(shard->mtx);
+            shard->map.clear();
+            shard->head = shard->tail = nullptr;
+            shard->bytes = 0;
+        }
+    }
+
+    [[nodiscard]] usize size() const { return sum([](Shard const &shard) { return shard.map.size(); }); }
+    [[nodiscard]] usize bytes() const { return sum([](Shard const &shard) { return shard.bytes; }); }
+    [[nodiscard]] usize capacity() const { return m_capacity; }
+    [[nodiscard]] CacheStats stats() const {
+        CacheStats total;
+        for (auto const &shard : m_shards) {
+            bee_lock(shard->mtx);
+            total.hits += shard->stats.hits;
+            total.misses += shard->stats.misses;
+            total.inserts += shard->stats.inserts;
+            total.evictions += shard->stats.evictions;
+        }
+        return total;
+    }
+
+private:
+    struct Entry {
+        V value {};
+        usize cost = 0;
+        K const *key = nullptr; // Points into the map node, which never moves
+        Entry *prev = nullptr;
+        Entry *next = nullptr;
+    };
+
+    struct Shard {
+        void push_front(Entry *entry) {
+            entry->prev = nullptr;
+            entry->next = head;
+            (head ? head->prev : tail) = entry;
+            head = entry;
+        }
+        void unlink(Entry *entry) {
+            (entry->prev ? entry->prev->next : head) = entry->next;
+            (entry->next ? entry->next->prev : tail) = entry->prev;
+        }
+        void touch(Entry *entry) {
+            if (entry != head) {
+                unlink(entry);
+                push_front(entry);
+            }
+        }
+        void evict(usize budget) {
+            while (bytes > budget && tail) {
+                Entry *victim = tail;
+                unlink(victim);
+                bytes -= victim->cost;
+                ++stats.evictions;
+                map.erase(map.find(*victim->key));
+            }
+        }
+
+        mutable Mutex mtx;
+        std::unordered_map<K, Entry, Hash, std::equal_to<>> map;
+        Entry *head = nullptr;
+        Entry *tail = nullptr;
+        usize bytes = 0;
+        CacheStats stats;
+    };
+
+    template <typename Q>
+    [[nodiscard]] Shard &shard_of(Q const &key) const {
+        usize const hash = Hash {}(key);
+        return *m_shards[(hash >> (sizeof(usize) * 4)) & (Shards - 1)]; // High half, low bits pick the bucket
+    }
+    [[nodiscard]] usize shard_capacity() const { return m_capacity / Shards; }
+
+    template <typename F>
+    [[nodiscard]] usize sum(F &&field) const {
+        usize total = 0;
+        for (auto const &shard : m_shards) {
+            bee_lock(shard->mtx);
+            total += field(*shard);
+        }
+        return total;
+    }
+
+    usize const m_capacity;
+    mutable Arr<Padded<Shard>, Shards> m_shards;
+};
+
+
+// ==============================================
+// ========== Memoize
+
+namespace details {
+
+// Cache key and result derived from the callable's signature (no generic lambdas)
+template <typename F>
+struct FnTraits : FnTraits<decltype(&F::operator())> {};
+
+template <typename R, typename... Args>
+struct FnTraits<R (*)(Args...)> {
+    using Result = R;
+    using Key = std::tuple<std::decay_t<Args>...>;
+};
+template <typename R, typename... Args>
+struct FnTraits<R (*)(Args...) noexcept> : FnTraits<R (*)(Args...)> {};
+template <typename C, typename R, typename... Args>
+struct FnTraits<R (C::*)(Args...)> : FnTraits<R (*)(Args...)> {};
+template <typename C, typename R, typename... Args>
+struct FnTraits<R (C::*)(Args...) const> : FnTraits<R (*)(Args...)> {};
+template <typename C, typename R, typename... Args>
+struct FnTraits<R (C::*)(Args...) noexcept> : FnTraits<R (*)(Args...)> {};
+template <typename C, typename R, typename... Args>
+struct FnTraits<R (C::*)(Args...) const noexcept> : FnTraits<R (*)(Args...)> {};
+
+// Hashes any tuple element-wise with bee::Hasher, so a tuple of references to
+// the call arguments finds the stored tuple of values
+struct TupleHasher {
+    using is_transparent = void;
+
+    template <typename... T>
+    [[nodiscard]] usize operator()(std::tuple<T...> const &tuple) const {
+        return std::apply(
+                [](auto const &...items) {
+                    u64 h = sizeof...(T);
+                    ((h = hash_mix(h ^ Hasher {}(items), 0x9e3779b97f4a7c15ull)), ...);
+                    return as(usize, h);
+                },
+                tuple);
+    }
+};
+
+// True when the call arguments can be looked up as they are: same types as
+// the key, or strings for a Str key (Hasher hashes both the same way)
+template <typename Arg, typename K>
+inline constexpr b8 key_as_is_v =
+        std::is_same_v<std::decay_t<Arg>, K> ||
+        (std::is_same_v<K, Str> && std::is_convertible_v<Arg const &, std::string_view>);
+
+template <typename Key, typename... Args>
+struct KeyAsIs : std::false_type {};
+template <typename... K, typename... Args>
+    requires(sizeof...(K) == sizeof...(Args))
+struct KeyAsIs<std::tuple<K...>, Args...> : std::bool_constant<(key_as_is_v<Args, K> && ...)> {};
+
+struct NoLock {
+    void lock() {}
+    void unlock() {}
+    void lock_shared() {}
+    void unlock_shared() {}
+};
+
+} // namespace details
+
+struct MemoOptions {
+    usize capacity = 0; // Max entries, the oldest is evicted first, 0 = unbounded
+    f64 ttl_ms = 0;     // Entries older than this are recomputed, 0 = never expire
+};
+
+// Cache in front of a pure callable. The call site is not type-erased: a hit is
+// one hash of the arguments (by reference) and one probe. Arguments are only
+// turned into a stored key on a miss, and rvalues are moved into it. Arguments
+// of another type than the key (an int for a double) are converted up front,
+// they would not hash like the stored key.
+// 'ThreadSafe' adds a shared_mutex: hits take it shared, misses exclusive.
+template <typename F, b8 ThreadSafe = false>
+class Memoized {
+    bee_nocopy_nomove(Memoized);
+
+    using Traits = details::FnTraits<F>;
+    using Key = typename Traits::Key;
+    using Result = std::decay_t<typename Traits::Result>;
+    using Counter = std::conditional_t<ThreadSafe, std::atomic<u64>, u64>;
+    using Lock = std::conditional_t<ThreadSafe, std::shared_mutex, details::NoLock>;
+
+public:
+    explicit Memoized(F fn, MemoOptions options = {}) : m_fn(std::move(fn)), m_options(options) {}
+
+    template <typename... Args>
+    Result operator()(Args &&...args) {
+        static_assert(sizeof...(Args) == std::tuple_size_v<Key>, "Memoized called with the wrong arity");
+        if constexpr (!details::KeyAsIs<Key, Args...>::value) {
+            return std::apply([this](auto &&...key) { return (*this)(std::move(key)...); },
+                              Key(std::forward<Args>(args)...));
+        } else {
+            {
+                bee_lock_shared(m_lock);
+                auto const it = m_entries.find(std::forward_as_tuple(std::as_const(args)...));
+                if (it != m_entries.end() && !expired(it->second)) {
+                    ++m_hits;
+                    return it->second.value;
+                }
+            }
+            ++m_misses;
+            Result value = std::invoke(m_fn, std::as_const(args)...);
+
+            bee_lock(m_lock);
+            auto [it, inserted] = m_entries.try_emplace(Key(std::forward<Args>(args)...), value);
+            if (!inserted) {
+                it->second.value = value; // Expired, or raced by another miss
+            }
+            if (m_options.ttl_ms > 0) {
+                it->second.age.reset();
+            }
+            if (inserted && m_options.capacity > 0) {
+                m_order.push_back(&it->first);
+                if (m_order.size() > m_options.capacity) {
+                    m_entries.erase(m_entries.find(*m_order.front()));
+                    m_order.pop_front();
+                    ++m_evictions;
+                }
+            }
+            return value;
+        }
+    }
+
+    void clear() {
+        bee_lock(m_lock);
+        m_entries.clear();
+        m_order.clear();
+    }
+
+    [[nodiscard]] usize size() {
+        bee_lock_shared(m_lock);
+        return m_entries.size();
+    }
+    [[nodiscard]] CacheStats stats() const {
+        return { .hits = m_hits, .misses = m_misses, .inserts = m_misses, .evictions = m_evictions };
+    }
+
+private:
+    struct Entry {
+        explicit Entry(Result value) : value(std::move(value)) {}
+        Result value;
+        ETimer age;
+    };
+
+    [[nodiscard]] b8 expired(Entry const &entry) const {
+        return m_options.ttl_ms > 0 && entry.age.elapsed_ms() > m_options.ttl_ms;
+    }
+
+    F m_fn;
+    MemoOptions const m_options;
+    Lock m_lock;
+    std::unordered_map<Key, Entry, details::TupleHasher, std::equal_to<>> m_entries;
+    std::deque<Key const *> m_order; // Insertion order, only used with a capacity
+    Counter m_hits = 0;
+    Counter m_misses = 0;
+    Counter m_evictions = 0;
+};
+
+template <b8 ThreadSafe = false, typename F>
+[[nodiscard]] auto memoize(F &&fn, MemoOptions options = {}) {
+    return Memoized<std::decay_t<F>, ThreadSafe>(std::forward<F>(fn), options);
+}
+
+
+// ==============================================
+// ========== IoRing
+
+#ifdef BEE_HAS_POSIX_IO
+
+namespace details {
+struct Uring;
+} // namespace details
+
+// Bytes transferred, or -errno
+using IoCallback = Fn<void(i64 result)>;
+
+// Batched asynchronous file I/O. On Linux ops go through io_uring (raw
+// syscalls, no liburing); otherwise, or when the kernel refuses a ring, they
+// run as pread/pwrite jobs on a ThreadPool. Either way ops are only queued
+// until 'submit' and callbacks only run inside 'poll'/'wait'/'drain', on the
+// calling thread, so they may queue more ops. When the kernel refuses a submit,
+// the ops it did not take complete with that -errno.
+class IoRing {
+    bee_nocopy_nomove(IoRing);
+
+public:
+    explicit IoRing(u32 entries = 256, ThreadPool &pool = thread_pool(), b8 allow_uring = true);
+    ~IoRing(); // Drains whatever is still in flight
+
+    [[nodiscard]] b8 uses_uring() const { return m_uring != nullptr; }
+
+    void read(i32 fd, Span<u8> buffer, u64 offset, IoCallback done);
+    void write(i32 fd, SpanConst<u8> data, u64 offset, IoCallback done);
+    void fsync(i32 fd, IoCallback done);
+
+    // Pins buffers once so 'read_fixed' skips the per-op page mapping
+    b8 register_buffers(SpanConst<Span<u8>> buffers);
+    void read_fixed(i32 fd, u16 buffer_index, Span<u8> range, u64 offset, IoCallback done);
+
+    // The next queued op only starts once the last queued one fully succeeded,
+    // otherwise it completes with -ECANCELED (e.g. write -> link -> fsync). A
+    // submit in between (explicit, or forced by a full queue) sends the last op
+    // alone, the next one then waits for its completion before being queued.
+    // Once cancelled, the rest of the chain is too, up to an op pushed unlinked.
+    void link();
+
+    u32 submit();
+    u32 poll();
+    u32 wait(u32 count = 1);
+    void drain();
+
+    [[nodiscard]] u32 in_flight() const { return m_in_flight; }
+    [[nodiscard]] u32 capacity() const { return m_capacity; }
+
+private:
+    enum class Code : u8 { Read, Write, ReadFixed, Fsync };
+
+    struct Op {
+        Code code = Code::Read;
+        b8 linked = false;
+        u16 buffer_index = 0;
+        i32 fd = -1;
+        u8 *buffer = nullptr;
+        usize size = 0;
+        u64 offset = 0;
+    };
+    struct Completion {
+        u32 index;
+        i64 result;
+    };
+
+    void push(Op const &op, IoCallback done);
+    [[nodiscard]] u32 track(IoCallback done);
+    void fail(u32 index, i64 result);
+    void fail_unsubmitted(i64 error);
+    void cut_chain();
+    void complete(Vec<Completion> &completions);
+    void run_chain(Vec<Op> chain, Vec<u32> indices);
+
+    u32 m_capacity;
+    ThreadPool &m_pool;
+    Uptr<details::Uring> m_uring;
+    Vec<Span<u8>> m_registered;
+
+    Vec<IoCallback> m_callbacks; // By op index
+    Vec<u32> m_free;
+    Vec<Op> m_queued; // Fallback only, not submitted yet
+    Vec<u32> m_queued_indices;
+    u32 m_in_flight = 0;
+
+    // 'link' state. Once a submit cut the chain, the op it was cut after is
+    // tracked until it completes, the linked op waits for its result.
+    Op m_last_op;
+    u32 m_last_index = u32_max;
+    b8 m_link_next = false;
+    b8 m_link_cut = false;
+    Op m_link_op;
+    u32 m_link_index = u32_max;
+    Opt<i64> m_link_result;
+    b8 m_link_cancelled = false;
+
+    std::mutex m_mtx; // Fallback completions filled by pool workers, and failed ops
+    Vec<Completion> m_completed;
+};
+
+// Reads every file fully through the ring, keeping up to 'capacity' reads in flight.
+// Files that can't be read come back empty (and are logged).
+[[nodiscard]] Vec<Str> file_read_many(SpanConst<Str> paths, IoRing &ring);
+
+#endif // BEE_HAS_POSIX_IO
+
+
+// ==============================================
+// ========== Directory Utils
+
+struct DirScanOptions {
+    Vec<Str> extensions; // Matched with 'file_check_extension', empty keeps every file
+    b8 recursive = true;
+    b8 follow_symlinks = false; // Else links are skipped. Directories reached twice are only scanned once
+    b8 include_hidden = true;
+};
+
+// Regular files under 'root', sorted. Every directory is listed by its own
+// pool job, so wide trees are walked concurrently.
+[[nodiscard]] Vec<Str> dir_scan(Str const &root, DirScanOptions const &options = {}, ThreadPool &pool = thread_pool());
+
+// Reads every file concurrently, 'out[i]' holds 'paths[i]'. False if any of
+// them failed, those come back empty.
+b8 files_load(SpanConst<Str> paths, Vec<Str> &out, ThreadPool &pool = thread_pool());
+
+// Same, but contents live in 'arena' (one allocation per file, done up front
+// on the calling thread) and 'out' views stay valid until it is rewound. Files
+// reporting no size (procfs) or that grew since they were sized are read
+// again into a Str, then copied into the arena.
+b8 files_load(SpanConst<Str> paths, ScratchArena &arena, Vec<std::string_view> &out,
+              ThreadPool &pool = thread_pool());
+
+
+// ==============================================
+// ========== File Cache
+
+namespace details {
+
+struct FileStamp {
+    i64 mtime_ns = 0;
+    u64 size = 0;
+    u64 inode = 0;
+    u64 device = 0;
+    [[nodiscard]] b8 operator==(FileStamp const &) const = default;
+};
+
+} // namespace details
+
+struct FileCacheOptions {
+    usize budget_bytes = 256 * 1024 * 1024;
+    // Linux only: inotify invalidates changed files, so hits skip the stat call.
+    // Takes one watch per distinct path, released once the file changes or on 'clear'.
+    b8 watch = false;
+};
+
+struct FileCacheStats {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 stale = 0; // Cached but changed on disk, reloaded
+    u64 invalidations = 0; // Watched entries dropped because the watcher saw their file change
+    u64 evictions = 0;
+};
+
+// Shared read-only file contents, copied onto the heap when loaded (see
+// MapHint::Copy). Entries are revalidated on every hit by mtime, size and
+// inode, or kept until the watcher drops them. Returned buffers are snapshots:
+// they stay valid and unchanged while held, even once the file is rewritten.
+class FileCache {
+    bee_nocopy_nomove(FileCache);
+
+public:
+    explicit FileCache(FileCacheOptions options = {});
+    ~FileCache();
+
+    // Null (and logged) when the file can't be read
+    [[nodiscard]] Sptr<MappedFile const> get(Str const &path);
+    b8 invalidate(Str const &path);
+    void clear();
+
+    [[nodiscard]] b8 watching() const { return m_inotify >= 0 && !m_watch_failed.load(std::memory_order_relaxed); }
+    [[nodiscard]] usize size() const { return m_cache.size(); }
+    [[nodiscard]] usize bytes() const { return m_cache.bytes(); }
+    [[nodiscard]] usize budget() const { return m_cache.capacity(); }
+    [[nodiscard]] FileCacheStats stats() const;
+    [[nodiscard]] f64 hit_rate() const;
+
+private:
+    struct Entry {
+        Sptr<MappedFile const> file;
+        details::FileStamp stamp;
+        b8 watched = false;
+    };
+
+    [[nodiscard]] Sptr<MappedFile const> load(Str const &path);
+    [[nodiscard]] u64 watch(Str const &path);
+    [[nodiscard]] b8 still_watched(Str const &path, u64 watch_id);
+    [[nodiscard]] Vec<Str> unwatch_all();
+    void watch_loop();
+
+    LruCache<Str, Entry, Hasher, 1> m_cache; // One shard, a file may take the whole budget
+
+    std::atomic<u64> m_hits = 0;
+    std::atomic<u64> m_misses = 0;
+    std::atomic<u64> m_stale = 0;
+    std::atomic<u64> m_invalidations = 0;
+
+    i32 m_inotify = -1;
+    i32 m_wake = -1;
+    std::atomic<b8> m_watch_failed = false; // The watcher stopped, entries use stat
+    std::thread m_watcher;
+    std::mutex m_watch_mtx;
+    Umap<Str, u64> m_watches;            // Path -> watch id, a new one every time the path gets watched
+    Umap<i32, Vec<Str>> m_watched_paths; // Hard links share a watch
+    u64 m_last_watch_id = 0;
+};
+
+// Process-wide cache with the default options, created on first use
+[[nodiscard]] FileCache &file_cache();
+
+
+// ==============================================
+// ========== File Watcher
+
+enum class FileEvent : u32 {
+    None = 0,
+    Created = bee_bit(0), // Also a file renamed into place, as editors do on save
+    Modified = bee_bit(1),
+    Removed = bee_bit(2),
+};
+[[nodiscard]] constexpr FileEvent operator|(FileEvent l, FileEvent r) { return as(FileEvent, as(u32, l) | as(u32, r)); }
+[[nodiscard]] constexpr b8 operator&(FileEvent l, FileEvent r) { return (as(u32, l) & as(u32, r)) != 0; }
+
+struct FileChange {
+    Str path;
+    FileEvent events = FileEvent::None; // Everything that happened since the last callback for this path
+};
+
+using FileWatchCallback = Fn<void(FileChange const &change)>;
+using WatchId = u64; // Zero is never a valid id
+
+// Linux only, one inotify thread per watcher. Events are debounced per path:
+// the callback runs once the path has been quiet for 'debounce_ms' (or after
+// ten such periods of constant changes), on the watcher thread. Files are
+// watched through their directory, so saves that replace the file are seen.
+// When the kernel drops events every subscription gets Modified, and when a
+// watched directory goes away its subscriptions get Removed, then stay silent.
+class FileWatcher {
+    bee_nocopy_nomove(FileWatcher);
+
+public:
+    explicit FileWatcher(i64 debounce_ms = 50);
+    ~FileWatcher(); // No callback runs once this returns, don't destroy it from one
+
+    // A file (that may not exist yet) or every entry directly inside a directory
+    [[nodiscard]] WatchId watch(Str const &path, FileWatchCallback callback);
+    b8 unwatch(WatchId id);
+
+    [[nodiscard]] b8 is_running() const { return m_thread.joinable(); }
+
+private:
+    struct Subscription {
+        i32 wd = -1;
+        Str name; // Empty for a whole directory
+        FileWatchCallback callback;
+    };
+    struct Directory {
+        Str path;
+        Vec<WatchId> ids;
+    };
+    struct Pending {
+        WatchId id = 0;
+        Str path;
+        FileEvent events = FileEvent::None;
+        i64 first_ns = 0;
+        i64 due_ns = 0;
+    };
+
+    void run();
+    void queue(WatchId id, Str const &path, FileEvent events);
+    void queue_all(Directory const &directory, FileEvent events);
+    void fire_due(i64 now_ns);
+
+    i64 m_debounce_ns;
+    i32 m_inotify = -1;
+    i32 m_wake = -1;
+    std::thread m_thread;
+
+    std::mutex m_mtx;
+    WatchId m_next_id = 1;
+    Umap<WatchId, Subscription> m_subscriptions;
+    Umap<i32, Directory> m_directories;
+    Vec<Pending> m_pending; // Watcher thread only
+};
+
+} // namespace bee
+
+
+// ############################################################################
+// #                                                                          #
+// #                                                                          #
+// #                            IMPLEMENTATION                                #
+// #                                                                          #
+// #                                                                          #
+// ############################################################################
+
+#ifdef BEE_IMPLEMENTATION
+
+#ifndef __BEE_IMPLEMENTATION_GUARD
+#define __BEE_IMPLEMENTATION_GUARD
+
+#include <cerrno>
+#include <fstream>
+
+#ifdef BEE_HAS_POSIX_IO
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BEE_HAS_IO_URING
+#endif
+#endif
+
+namespace bee {
+namespace fs = std::filesystem;
+
+// ==============================================
+// ========== Elapsed Timer
+
+void ElapsedTimer::reset() {
+    m_valid = true;
+    m_ref = mono_now_ns();
+}
+f64 ElapsedTimer::elapsed_s() const { return as(f64, elapsed()) * ns_to_s; }
+f64 ElapsedTimer::elapsed_ms() const { return as(f64, elapsed()) * ns_to_ms; }
+f64 ElapsedTimer::elapsed_us() const { return as(f64, elapsed()) * ns_to_us; }
+f64 ElapsedTimer::elapsed_ns() const { return as(f64, elapsed()); }
+b8 ElapsedTimer::is_valid() const { return m_valid; }
+i64 ElapsedTimer::elapsed() const { return mono_now_ns() - m_ref; }
+
+
+// ==============================================
+// ========== Timer Wheel
+
+TimerWheel::TimerWheel(i64 tick_ns, i64 start_ns) : m_tick_ns(std::max<i64>(tick_ns, 1)), m_start_ns(start_ns) {}
+
+TimerId TimerWheel::schedule_at(i64 deadline_ns, u64 data) {
+    u32 index = 0;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = as(u32, m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    // Round up so a timer never fires early, and never in the tick we already processed
+    i64 const offset = std::max<i64>(deadline_ns - m_start_ns, 0);
+    u64 const deadline = as(u64, (offset + m_tick_ns - 1) / m_tick_ns);
+
+    Node &node = m_nodes[index];
+    node.deadline = std::max(deadline, m_tick + 1);
+    node.data = data;
+    node.generation += 1;
+    place(index);
+    ++m_size;
+    return (as(u64, node.generation) << 32) | index;
+}
+
+b8 TimerWheel::cancel(TimerId id) {
+    if (!pending(id)) {
+        return false;
+    }
+    u32 const index = as(u32, id);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+b8 TimerWheel::pending(TimerId id) const {
+    u32 const index = as(u32, id);
+    return index < m_nodes.size() && (m_nodes[index].generation & 1) &&
+           m_nodes[index].generation == as(u32, id >> 32);
+}
+
+void TimerWheel::reserve(usize timers) {
+    m_nodes.reserve(timers);
+    m_free.reserve(timers);
+}
+
+void TimerWheel::clear() {
+    for (u32 index = 0; index < m_nodes.size(); ++index) {
+        if (m_nodes[index].generation & 1) {
+            m_nodes[index].bucket = nil;
+            release(index);
+        }
+    }
+    std::fill(m_buckets.begin(), m_buckets.end(), nil);
+    m_level_sizes.fill(0);
+}
+
+void TimerWheel::collect(i64 now_ns, Vec<Expired> &out) {
+    if (now_ns < m_start_ns) {
+        return;
+    }
+    u64 const target = as(u64, (now_ns - m_start_ns) / m_tick_ns);
+
+    while (m_tick < target) {
+        // Jump straight to the next boundary of the first non-empty level
+        u64 next = target;
+        for (u32 level = 0; level < levels; ++level) {
+            if (m_level_sizes[level] != 0) {
+                u64 const span = 1ull << (slot_bits * level);
+                next = std::min(target, (m_tick | (span - 1)) + 1);
+                break;
+            }
+        }
+        m_tick = next;
+
+        for (u32 level = 1; level < levels; ++level) {
+            if ((m_tick & ((1ull << (slot_bits * level)) - 1)) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        u32 &head = m_buckets[m_tick & (slots - 1)];
+        while (head != nil) {
+            u32 const index = head;
+            Node &node = m_nodes[index];
+            out.push_back({ (as(u64, node.generation) << 32) | index, node.data });
+            unlink(index);
+            release(index);
+        }
+    }
+}
+
+void TimerWheel::place(u32 index) {
+    Node &node = m_nodes[index];
+    u64 const delta = node.deadline - m_tick;
+
+    u32 level = 0;
+    while (level < levels - 1 && delta >= (1ull << (slot_bits * (level + 1)))) {
+        ++level;
+    }
+    // Past the top level range: park it in the farthest slot, it is re-cascaded from there
+    u64 const capped = std::min<u64>(delta, (1ull << (slot_bits * levels)) - 1) + m_tick;
+    u32 const bucket = level * slots + as(u32, (capped >> (slot_bits * level)) & (slots - 1));
+
+    node.bucket = bucket;
+    node.prev = nil;
+    node.next = m_buckets[bucket];
+    if (node.next != nil) {
+        m_nodes[node.next].prev = index;
+    }
+    m_buckets[bucket] = index;
+    ++m_level_sizes[level];
+}
+
+void TimerWheel::unlink(u32 index) {
+    Node &node = m_nodes[index];
+    if (node.prev != nil) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_buckets[node.bucket] = node.next;
+    }
+    if (node.next != nil) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    --m_level_sizes[node.bucket / slots];
+    node.bucket = nil;
+}
+
+void TimerWheel::release(u32 index) {
+    m_nodes[index].generation += 1;
+    m_free.push_back(index);
+    --m_size;
+}
+
+void TimerWheel::cascade(u32 level) {
+    u32 const bucket = level * slots + as(u32, (m_tick >> (slot_bits * level)) & (slots - 1));
+    u32 index = std::exchange(m_buckets[bucket], nil);
+    while (index != nil) {
+        u32 const next = m_nodes[index].next;
+        --m_level_sizes[level];
+        place(index);
+        index = next;
+    }
+}
+
+
+// ==============================================
+// ========== String Utils
+
+Str str_lower(Str str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+Str str_upper(Str str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    return str;
+}
+Str str_capital(Str str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    std::transform(str.begin(), str.begin() + 1, str.begin(), ::toupper);
+    return str;
+}
+
+b8 str_contains(Str const &str, Str const &substr) { return str.find(substr) < str.size(); }
+
+Vec<Str> str_split(Str const &str, Str const &delimeter) {
+
+    Str token;
+    Vec<Str> splitted;
+    usize ini = 0;
+    usize end = 0;
+
+    // Split and store the string body
+    while ((end = str.find(delimeter, ini)) < str.size()) {
+        token = str.substr(ini, end - ini);
+        ini = end + delimeter.size();
+        splitted.push_back(token);
+    }
+
+    // Store the string tail
+    if (ini < str.size()) {
+        token = str.substr(ini);
+        splitted.push_back(token);
+    }
+
+    return splitted;
+}
+
+Str str_join(Vec<Str> const &strlist, Str const &delimeter) {
+
+    if (strlist.empty()) {
+        return "";
+    }
+
+    Str s;
+    for (usize i = 0; i < strlist.size() - 1; ++i) {
+        s += strlist[i] + delimeter;
+    }
+    s += strlist[strlist.size() - 1];
+
+    return s;
+}
+
+Str str_replace(Str str, Str const &from, Str const &to, b8 only_first_match) {
+    usize pos = 0;
+    while ((pos = str.find(from)) < str.size()) {
+        str.replace(pos, from.length(), to);
+        if (only_first_match) {
+            break;
+        }
+    }
+    return str;
+}
+
+Str str_replace_many(Str str, Vec<Str> const &from, Vec<Str> const &to, b8 sorted) {
+
+    b8 const same_size = from.size() == to.size();
+    b8 const is_empty = same_size && from.size() < 1;
+    if (!same_size || is_empty) {
+        if (!same_size) {
+            assert(0);
+        }
+        return str;
+    }
+
+    usize pos = 0;
+    usize i = 0;
 
     usize anchor = 0;
     while (i < from.size() && (pos = str.find(from[i], anchor)) < str.size()) {
@@ -741,139 +3984,2685 @@ Str str_replace_many(Str str, Vec<Str> const &from, Vec<Str> const &to, b8 sorte
         if (sorted) {
             anchor = pos;
         }
-        ++i;
+        ++i;
+    }
+    return str;
+}
+
+Str str_cut(Str const &str, i32 count) { return str_cut_r(str_cut_l(str, count), count); }
+Str str_cut_l(Str const &str, i32 count) { return str.substr(count); }
+Str str_cut_r(Str const &str, i32 count) { return str.substr(0, std::max(i32(str.size()) - count, count)); }
+
+Str str_trim(Str str, Str const &individual_chars_to_remove) {
+    auto const l = str_trim_l(str, individual_chars_to_remove);
+    return str_trim_r(l, individual_chars_to_remove);
+}
+Str str_trim_l(Str str, Str const &individual_chars_to_remove) {
+    return str.erase(0, str.find_first_not_of(individual_chars_to_remove));
+}
+Str str_trim_r(Str str, Str const &individual_chars_to_remove) {
+    return str.erase(str.find_last_not_of(individual_chars_to_remove) + 1);
+}
+
+
+// ==============================================
+// ========== Hashing
+
+namespace details {
+
+inline u64 hash_read64(u8 const *p) {
+    u64 value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+inline u64 hash_read32(u8 const *p) {
+    u32 value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+} // namespace details
+
+u64 hash_bytes(void const *data, usize size, u64 seed) {
+    constexpr u64 k0 = 0xa0761d6478bd642full;
+    constexpr u64 k1 = 0xe7037ed1a0b428dbull;
+    constexpr u64 k2 = 0x8ebc6af09c88c6e3ull;
+
+    u8 const *p = recast(u8 const *, data);
+    u64 h = seed ^ details::hash_mix(seed ^ k0, k1);
+    usize left = size;
+    while (left > 16) {
+        h = details::hash_mix(details::hash_read64(p) ^ k1, details::hash_read64(p + 8) ^ h);
+        p += 16;
+        left -= 16;
+    }
+
+    u64 a = 0;
+    u64 b = 0;
+    if (left >= 8) {
+        a = details::hash_read64(p);
+        b = details::hash_read64(p + left - 8);
+    } else if (left >= 4) {
+        a = details::hash_read32(p);
+        b = details::hash_read32(p + left - 4);
+    } else if (left > 0) {
+        a = (as(u64, p[0]) << 16) | (as(u64, p[left >> 1]) << 8) | p[left - 1];
+    }
+    return details::hash_mix(k2 ^ size, details::hash_mix(a ^ k1, b ^ h));
+}
+
+
+// ==============================================
+// ========== Binary Utils
+
+namespace details {
+
+// Sizes the buffer once with fstat and fills it with large read() calls. Sizes
+// reported by fstat are only trusted as a first guess, so pipes and procfs
+// (which report 0) just grow the buffer until EOF.
+template <typename Buffer>
+b8 read_whole_file(Str const &path, Buffer &out) {
+#ifdef BEE_HAS_POSIX_IO
+    int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        bee_err("[read] Opening file: {}", path);
+        out.clear();
+        return false;
+    }
+    defer(::close(fd));
+
+    struct stat info {};
+    b8 const sized = fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0;
+    usize const expected = sized ? as(usize, info.st_size) : 0;
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (sized) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    constexpr usize max_chunk = 1 << 30;
+    usize filled = 0;
+    out.resize(sized ? expected : 64 * 1024);
+    while (true) {
+        if (filled == out.size()) {
+            if (filled == expected) { // Usual case, check for EOF without growing the buffer
+                char probe = 0;
+                ssize_t const n = ::read(fd, &probe, 1);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    bee_err("[read] Reading file: {}", path);
+                    out.clear();
+                    return false;
+                }
+                if (n == 0) {
+                    break;
+                }
+                out.resize(filled * 2);
+                out[filled++] = as(typename Buffer::value_type, probe);
+                continue;
+            }
+            out.resize(out.size() * 2);
+        }
+        ssize_t const n = ::read(fd, out.data() + filled, std::min(out.size() - filled, max_chunk));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            bee_err("[read] Reading file: {}", path);
+            out.clear();
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        filled += as(usize, n);
+    }
+    out.resize(filled);
+    return true;
+#else
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        bee_err("[read] Opening file: {}", path);
+        out.clear();
+        return false;
+    }
+    out.resize(as(usize, file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(recast(char *, out.data()), as(std::streamsize, out.size()));
+    return true;
+#endif
+}
+
+} // namespace details
+
+Vec<u8> bin_read(Str const &path) {
+    Vec<u8> content;
+    details::read_whole_file(path, content);
+    return content;
+}
+b8 bin_read(Str const &path, Vec<u8> &out) { return details::read_whole_file(path, out); }
+
+b8 bin_check_magic(SpanConst<u8> bin, SpanConst<u8> magic) {
+    // Validation
+    if (magic.empty() || bin.size() < magic.size()) {
+        return false;
+    }
+    // Iteration
+    b8 match = true;
+    for (usize i = 0; i < magic.size(); ++i) {
+        match &= (bin[i] == magic[i]);
+    }
+    // Result
+    return match;
+}
+
+
+// ==============================================
+// ========== Files Utils
+
+Str file_read(Str const &input_file) {
+    Str content;
+    details::read_whole_file(input_file, content);
+    return content;
+}
+b8 file_read(Str const &input_file, Str &out) { return details::read_whole_file(input_file, out); }
+
+b8 file_write(Str const &output_file, char const *data, usize data_size, WriteMode mode) {
+    if (!data || data_size < 1) {
+        bee_err("[file_write] Invalid data: {}", output_file);
+        return false;
+    }
+
+    FileWriter file(output_file, mode, {}, 0); // One-shot, no point in buffering
+    return file.is_open() && file.write(data, data_size) && file.close();
+}
+b8 file_write_append(Str const &output_file, Str const &to_write) {
+    return file_write(output_file, to_write.data(), to_write.size(), WriteMode::Append);
+}
+b8 file_write_trunc(Str const &output_file, Str const &to_write) {
+    return file_write(output_file, to_write.data(), to_write.size(), WriteMode::Trunc);
+}
+b8 file_write_append(Str const &output_file, const char *data, usize data_size) {
+    return file_write(output_file, data, data_size, WriteMode::Append);
+}
+b8 file_write_trunc(Str const &output_file, const char *data, usize data_size) {
+    return file_write(output_file, data, data_size, WriteMode::Trunc);
+}
+
+b8 file_check_extension(Str const &input_file, Str ext) {
+    auto to_check = input_file.substr(input_file.find_last_of('.') + 1);
+    std::transform(to_check.begin(), to_check.end(), to_check.begin(), ::tolower);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return to_check == ext;
+}
+
+
+// ==============================================
+// ========== File Writer
+
+namespace details {
+
+#ifdef BEE_HAS_POSIX_IO
+inline i32 fd_open_write(Str const &path, WriteMode mode) {
+    i32 const flags = O_WRONLY | O_CREAT | O_CLOEXEC | (mode == WriteMode::Append ? O_APPEND : O_TRUNC);
+    return ::open(path.c_str(), flags, 0666); // Same as ofstream, the umask applies
+}
+inline b8 fd_sync(i32 fd) { return fsync(fd) == 0; }
+inline void fd_close(i32 fd) { ::close(fd); }
+inline i32 fd_open_read(Str const &path) { return ::open(path.c_str(), O_RDONLY | O_CLOEXEC); }
+inline isize fd_read(i32 fd, char *data, usize size) { return ::read(fd, data, size); }
+#elif defined(_WIN32)
+inline i32 fd_open_write(Str const &path, WriteMode mode) {
+    i32 const flags = _O_WRONLY | _O_CREAT | _O_BINARY | (mode == WriteMode::Append ? _O_APPEND : _O_TRUNC);
+    return _open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+}
+inline b8 fd_sync(i32 fd) { return _commit(fd) == 0; }
+inline void fd_close(i32 fd) { _close(fd); }
+inline i32 fd_open_read(Str const &path) { return _open(path.c_str(), _O_RDONLY | _O_BINARY); }
+inline isize fd_read(i32 fd, char *data, usize size) { return _read(fd, data, as(u32, size)); }
+#endif
+
+// Writes every part, retrying partial writes, in as few syscalls as possible
+inline b8 fd_write_all(i32 fd, SpanConst<std::string_view> parts) {
+#ifdef BEE_HAS_POSIX_IO
+    constexpr usize max_iov = 64;
+    Arr<iovec, max_iov> iov;
+    usize next = 0;
+    while (next < parts.size()) {
+        usize count = 0;
+        for (; count < max_iov && next + count < parts.size(); ++count) {
+            iov[count] = { const_cast<char *>(parts[next + count].data()), parts[next + count].size() };
+        }
+        iovec *pending = iov.data();
+        while (count > 0) {
+            ssize_t written = ::writev(fd, pending, as(i32, count));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            while (count > 0 && as(usize, written) >= pending->iov_len) { // Skip what is fully written
+                written -= as(ssize_t, pending->iov_len);
+                ++pending;
+                --count;
+                ++next;
+            }
+            if (count > 0) {
+                pending->iov_base = recast(char *, pending->iov_base) + written;
+                pending->iov_len -= as(usize, written);
+            }
+        }
+    }
+    return true;
+#else
+    for (std::string_view part : parts) {
+        while (!part.empty()) {
+            i32 const written = _write(fd, part.data(), as(u32, std::min<usize>(part.size(), 1 << 30)));
+            if (written < 0) {
+                return false;
+            }
+            part.remove_prefix(as(usize, written));
+        }
+    }
+    return true;
+#endif
+}
+
+} // namespace details
+
+FileWriter &FileWriter::operator=(FileWriter &&other) noexcept {
+    if (this != &other) {
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+        m_path = std::move(other.m_path);
+        m_buffer = std::move(other.m_buffer);
+        m_capacity = other.m_capacity;
+        m_fsync = other.m_fsync;
+        m_unsynced = other.m_unsynced;
+        m_since_sync = other.m_since_sync;
+        m_start = other.m_start;
+        m_written = other.m_written;
+        m_syncs = other.m_syncs;
+    }
+    return *this;
+}
+
+b8 FileWriter::open(Str const &path, WriteMode mode, FsyncPolicy fsync, usize buffer_size) {
+    close();
+    m_fd = details::fd_open_write(path, mode);
+    if (m_fd < 0) {
+        bee_err("[FileWriter] Opening file: {}", path);
+        return false;
+    }
+    m_path = path;
+    m_capacity = buffer_size;
+    m_buffer.clear();
+    m_buffer.reserve(buffer_size);
+    m_fsync = fsync;
+    m_unsynced = 0;
+    m_since_sync.reset();
+    std::error_code ec;
+    m_start = mode == WriteMode::Append ? as(u64, fs::file_size(path, ec)) : 0;
+    m_start = ec ? 0 : m_start;
+    m_written = 0;
+    m_syncs = 0;
+    return true;
+}
+
+b8 FileWriter::close() {
+    if (!is_open()) {
+        return true;
+    }
+    b8 ok = flush();
+    if (m_fsync.on_close && m_unsynced > 0) {
+        ok &= details::fd_sync(m_fd);
+        ++m_syncs;
+    }
+    details::fd_close(m_fd);
+    m_fd = -1;
+    m_buffer = {};
+    return ok;
+}
+
+b8 FileWriter::write(void const *data, usize size) {
+    if (!is_open()) {
+        return false;
+    }
+    m_written += size;
+    if (m_buffer.size() + size <= m_capacity) {
+        u8 const *bytes = recast(u8 const *, data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        return true;
+    }
+    std::string_view const part { recast(char const *, data), size };
+    return write_parts({ &part, 1 });
+}
+
+b8 FileWriter::writev(SpanConst<std::string_view> parts) {
+    if (!is_open()) {
+        return false;
+    }
+    usize total = 0;
+    for (std::string_view const part : parts) {
+        total += part.size();
+    }
+    m_written += total;
+    if (m_buffer.size() + total <= m_capacity) {
+        for (std::string_view const part : parts) {
+            m_buffer.insert(m_buffer.end(), part.begin(), part.end());
+        }
+        return true;
+    }
+    return write_parts(parts);
+}
+
+b8 FileWriter::flush() {
+    if (!is_open()) {
+        return false;
+    }
+    return m_buffer.empty() || write_parts({});
+}
+
+b8 FileWriter::sync() {
+    if (!flush()) {
+        return false;
+    }
+    b8 const ok = details::fd_sync(m_fd);
+    m_unsynced = 0;
+    m_since_sync.reset();
+    ++m_syncs;
+    return ok;
+}
+
+b8 FileWriter::write_parts(SpanConst<std::string_view> parts) {
+    // The pending block goes first, in the same syscall as the new parts
+    constexpr usize inline_parts = 8;
+    Arr<std::string_view, inline_parts> small;
+    Vec<std::string_view> large;
+    Span<std::string_view> all = small;
+    if (parts.size() >= inline_parts) {
+        large.resize(parts.size() + 1);
+        all = large;
+    }
+    all[0] = { recast(char const *, m_buffer.data()), m_buffer.size() };
+    std::copy(parts.begin(), parts.end(), all.begin() + 1);
+    all = all.first(parts.size() + 1);
+
+    usize flushed = 0;
+    for (std::string_view const part : all) {
+        flushed += part.size();
+    }
+    b8 const ok = details::fd_write_all(m_fd, all);
+    m_buffer.clear();
+    if (!ok) {
+        bee_err("[FileWriter] Writing file: {}", m_path);
+        return false;
+    }
+    apply_policy(flushed);
+    return true;
+}
+
+void FileWriter::apply_policy(usize flushed) {
+    m_unsynced += flushed;
+    b8 const by_size = m_fsync.every_bytes > 0 && m_unsynced >= m_fsync.every_bytes;
+    b8 const by_time = m_fsync.every_ms > 0 && m_since_sync.elapsed_ms() >= m_fsync.every_ms;
+    if (by_size || by_time) {
+        details::fd_sync(m_fd);
+        m_unsynced = 0;
+        m_since_sync.reset();
+        ++m_syncs;
+    }
+}
+
+
+// ==============================================
+// ========== Durable Writes
+
+namespace details {
+
+// Hidden, unique name in the target's directory, so renaming it over the target stays on one filesystem
+inline fs::path sibling_temp(fs::path const &target) {
+    static std::atomic<u64> counter = 0;
+    fs::path const dir = target.has_parent_path() ? target.parent_path() : fs::path(".");
+    u64 const unique = hash_u64(as(u64, mono_now_ns()) ^ counter.fetch_add(1, std::memory_order_relaxed));
+    return dir / ("." + target.filename().string() + "." + std::to_string(unique) + ".tmp");
+}
+
+} // namespace details
+
+b8 file_write_atomic(Str const &output_file, std::string_view contents) {
+    return file_write_atomic(output_file, contents.data(), contents.size());
+}
+
+b8 file_write_atomic(Str const &output_file, char const *data, usize data_size) {
+    fs::path const target(output_file);
+    fs::path const dir = target.has_parent_path() ? target.parent_path() : fs::path(".");
+    fs::path const temp = details::sibling_temp(target);
+
+    std::error_code ec;
+    FileWriter writer(temp.string(), WriteMode::Trunc, {}, 0);
+    b8 ok = writer.is_open() && (data_size == 0 || writer.write(data, data_size)) && writer.sync() && writer.close();
+    if (ok && fs::exists(target, ec)) {
+        fs::permissions(temp, fs::status(target, ec).permissions(), ec);
+    }
+    if (ok) {
+        fs::rename(temp, target, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        bee_err("[file_write_atomic] Writing file: {}", output_file);
+        fs::remove(temp, ec);
+        return false;
+    }
+
+#ifdef BEE_HAS_POSIX_IO
+    // The rename only lives in the directory until that one is synced too
+    i32 const dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0 || !details::fd_sync(dir_fd)) {
+        bee_err("[file_write_atomic] Syncing directory of: {}", output_file);
+        ok = false;
+    }
+    if (dir_fd >= 0) {
+        details::fd_close(dir_fd);
+    }
+#endif
+    return ok;
+}
+
+b8 file_copy(Str const &from, Str const &to) {
+#ifdef BEE_HAS_POSIX_IO
+    i32 const in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        bee_err("[file_copy] Opening file: {}", from);
+        return false;
+    }
+    defer(::close(in));
+    struct stat info {};
+    if (fstat(in, &info) != 0 || !S_ISREG(info.st_mode)) {
+        bee_err("[file_copy] Not a regular file: {}", from);
+        return false;
+    }
+    struct stat target {};
+    if (::stat(to.c_str(), &target) == 0 && target.st_dev == info.st_dev && target.st_ino == info.st_ino) {
+        bee_err("[file_copy] Copying {} onto itself", from);
+        return false;
+    }
+    Str const temp = details::sibling_temp(to).string();
+    i32 const out = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 07777);
+    if (out < 0) {
+        bee_err("[file_copy] Opening file: {}", temp);
+        return false;
+    }
+    fchmod(out, info.st_mode & 07777); // The umask applied on creation
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    // Until EOF rather than 'st_size', the source may still be growing. A kernel
+    // path that refuses this pair of files before copying anything hands over
+    // to the next one, both keep the file offsets in step. So does one that
+    // copies nothing at first: procfs and sysfs files only give data to read().
+    constexpr usize max_chunk = 1 << 30;
+    usize copied = 0;
+    b8 done = false;
+    b8 failed = false;
+    auto const pump = [&](b8 kernel, auto &&step) {
+        while (!done && !failed) {
+            isize const n = step();
+            if (kernel && n == 0 && copied == 0) {
+                return;
+            }
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                b8 const unsupported = errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP;
+                failed = !(unsupported && copied == 0);
+                return;
+            }
+            done = n == 0;
+            copied += as(usize, n);
+        }
+    };
+#ifdef __linux__
+    pump(true, [&] { return as(isize, copy_file_range(in, nullptr, out, nullptr, max_chunk, 0)); });
+    pump(true, [&] { return as(isize, sendfile(out, in, nullptr, max_chunk)); });
+#endif
+    if (!done && !failed) {
+        Vec<char> buffer(1 << 20);
+        pump(false, [&] {
+            isize const n = details::fd_read(in, buffer.data(), buffer.size());
+            std::string_view const part[1] = { { buffer.data(), n > 0 ? as(usize, n) : 0 } };
+            if (n > 0 && !details::fd_write_all(out, part)) {
+                errno = EIO;
+                return isize(-1);
+            }
+            return n;
+        });
+    }
+
+    b8 const closed = ::close(out) == 0;
+    b8 const renamed = !failed && done && closed && ::rename(temp.c_str(), to.c_str()) == 0;
+    if (!renamed) {
+        bee_err("[file_copy] Copying {} to {}", from, to);
+        ::unlink(temp.c_str());
+        return false;
+    }
+    return true;
+#else
+    std::error_code ec;
+    if (fs::equivalent(from, to, ec)) {
+        bee_err("[file_copy] Copying {} onto itself", from);
+        return false;
+    }
+    fs::path const temp = details::sibling_temp(to);
+    fs::copy_file(from, temp, ec);
+    if (!ec) {
+        fs::rename(temp, to, ec);
+    }
+    if (ec) {
+        bee_err("[file_copy] Copying {} to {}", from, to);
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+#endif
+}
+
+
+// ==============================================
+// ========== Mapped Files
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_open = std::exchange(other.m_open, false);
+        m_mapped = std::exchange(other.m_mapped, false);
+        m_heap = std::move(other.m_heap); // Moving keeps the buffer, 'm_data' stays valid
+    }
+    return *this;
+}
+
+b8 MappedFile::open(Str const &path, MapHint hints) {
+    close();
+    if (hints & MapHint::Copy) {
+        if (!bin_read(path, m_heap)) {
+            return false;
+        }
+        m_data = m_heap.data();
+        m_size = m_heap.size();
+        m_open = true;
+        return true;
+    }
+
+#ifdef BEE_HAS_POSIX_IO
+    int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        bee_err("[MappedFile] Opening file: {}", path);
+        return false;
+    }
+    defer(::close(fd)); // The mapping keeps its own reference to the file
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        bee_err("[MappedFile] Not a regular file: {}", path);
+        return false;
+    }
+
+    m_size = as(usize, info.st_size);
+    m_open = true;
+    if (m_size == 0) {
+        return true; // mmap refuses empty ranges, an empty view is fine
+    }
+
+    void *const addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        bee_err("[MappedFile] Mapping file: {}", path);
+        m_size = 0;
+        m_open = false;
+        return false;
+    }
+    m_data = recast(u8 const *, addr);
+    m_mapped = true;
+    advise(hints);
+    return true;
+#else
+    (void)hints;
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        bee_err("[MappedFile] Opening file: {}", path);
+        return false;
+    }
+    m_heap.resize(as(usize, file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(recast(char *, m_heap.data()), as(std::streamsize, m_heap.size()));
+    m_data = m_heap.data();
+    m_size = m_heap.size();
+    m_open = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef BEE_HAS_POSIX_IO
+    if (m_mapped) {
+        munmap(recast(void *, m_data), m_size);
+    }
+#endif
+    m_heap = {};
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_mapped = false;
+}
+
+b8 MappedFile::advise(MapHint hints) const {
+#ifdef BEE_HAS_POSIX_IO
+    if (!m_mapped) {
+        return false;
+    }
+    void *const addr = recast(void *, m_data);
+    b8 ok = true;
+    if (hints & MapHint::Sequential) {
+        ok &= madvise(addr, m_size, MADV_SEQUENTIAL) == 0;
+    }
+    if (hints & MapHint::Random) {
+        ok &= madvise(addr, m_size, MADV_RANDOM) == 0;
+    }
+    if (hints & MapHint::WillNeed) {
+        ok &= madvise(addr, m_size, MADV_WILLNEED) == 0;
+    }
+#ifdef MADV_HUGEPAGE
+    if (hints & MapHint::HugePages) {
+        madvise(addr, m_size, MADV_HUGEPAGE); // Only a hint, most filesystems ignore it
+    }
+#endif
+    return ok;
+#else
+    (void)hints;
+    return false;
+#endif
+}
+
+MappedFile file_view(Str const &path, MapHint hints) { return MappedFile(path, hints); }
+MappedFile bin_view(Str const &path, MapHint hints) { return MappedFile(path, hints); }
+
+
+// ==============================================
+// ========== Record Reader
+
+RecordReader::RecordReader(Str const &path, char delimiter, usize chunk_size)
+    : m_path(path), m_delimiter(delimiter) {
+    m_fd = details::fd_open_read(path);
+    if (m_fd < 0) {
+        bee_err("[RecordReader] Opening file: {}", path);
+        m_eof = true;
+        return;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    m_front.resize(std::max<usize>(chunk_size, 1));
+    m_back.resize(m_front.size());
+    m_thread = std::thread([this] { read_ahead(); });
+}
+
+RecordReader::~RecordReader() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard lock(m_mtx);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+    if (m_fd >= 0) {
+        details::fd_close(m_fd);
+    }
+}
+
+void RecordReader::read_ahead() {
+    while (true) {
+        {
+            std::unique_lock lock(m_mtx);
+            m_cv.wait(lock, [&] { return m_stop || !m_back_ready; });
+            if (m_stop) {
+                return;
+            }
+        }
+
+        // Fill the whole chunk, short reads only mean EOF when they return 0
+        usize filled = 0;
+        b8 failed = false;
+        while (filled < m_back.size()) {
+            isize const n = details::fd_read(m_fd, m_back.data() + filled, m_back.size() - filled);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                failed = n < 0;
+                break;
+            }
+            filled += as(usize, n);
+        }
+
+        std::lock_guard lock(m_mtx);
+        m_back_size = filled;
+        m_back_failed = failed;
+        m_back_ready = true;
+        m_cv.notify_all();
+        if (filled < m_back.size()) {
+            return; // EOF or error, nothing more to read ahead
+        }
+    }
+}
+
+b8 RecordReader::swap_chunks() {
+    if (m_eof) {
+        return false;
+    }
+    {
+        std::unique_lock lock(m_mtx);
+        m_cv.wait(lock, [&] { return m_back_ready; });
+        std::swap(m_front, m_back);
+        m_front_size = m_back_size;
+        m_cursor = 0;
+        m_back_ready = false;
+        if (m_back_failed) {
+            bee_err("[RecordReader] Reading file: {}", m_path);
+            m_failed = true;
+        }
+        m_eof = m_front_size < m_front.size();
+    }
+    m_cv.notify_all();
+    m_bytes += m_front_size;
+    return m_front_size > 0;
+}
+
+b8 RecordReader::next(std::string_view &record) {
+    auto const finish = [&](std::string_view found) {
+        if (m_trim_cr && !found.empty() && found.back() == '\r') {
+            found.remove_suffix(1);
+        }
+        record = found;
+        ++m_records;
+        return true;
+    };
+
+    m_carry.clear();
+    b8 carrying = false;
+    while (true) {
+        if (m_cursor < m_front_size) {
+            char const *const begin = m_front.data() + m_cursor;
+            usize const left = m_front_size - m_cursor;
+            auto const *const hit = recast(char const *, std::memchr(begin, m_delimiter, left));
+            if (hit) {
+                usize const length = as(usize, hit - begin);
+                m_cursor += length + 1;
+                if (!carrying) {
+                    return finish({ begin, length }); // Usual case, a view straight into the chunk
+                }
+                m_carry.append(begin, length);
+                return finish(m_carry);
+            }
+            m_carry.append(begin, left);
+            carrying = true;
+            m_cursor = m_front_size;
+        }
+        if (!swap_chunks()) {
+            return carrying && !m_failed ? finish(m_carry) : false;
+        }
+    }
+}
+
+
+// ==============================================
+// ========== Math Utils
+
+f32 map(f32 value, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax) {
+    return dstMin + (dstMax - dstMin) * (value - srcMin) / (srcMax - srcMin);
+}
+f32 map_100(f32 value, f32 dstMin, f32 dstMax) { return map(value, 0, 100, dstMin, dstMax); }
+
+b8 fuzzy_eq(f32 f1, f32 f2, f32 threshold) {
+    auto const diff = abs(f1 - f2);
+    auto const isEq = diff <= threshold;
+    return isEq;
+}
+
+f32 clamp_angle(f32 angle) {
+    auto const turns = floorf(angle / 360.f);
+    return angle - 360.f * turns;
+}
+
+void map(SpanConst<f32> values, Span<f32> out, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax) {
+    f32 const scale = (dstMax - dstMin) / (srcMax - srcMin);
+    usize const count = std::min(values.size(), out.size());
+    for (usize i = 0; i < count; ++i) {
+        out[i] = dstMin + (values[i] - srcMin) * scale;
+    }
+}
+
+b8 fuzzy_eq(SpanConst<f32> v1, SpanConst<f32> v2, f32 threshold) {
+    if (v1.size() != v2.size()) {
+        return false;
+    }
+    // Branchless on purpose, an early exit would block vectorization
+    b8 isEq = true;
+    for (usize i = 0; i < v1.size(); ++i) {
+        isEq &= std::abs(v1[i] - v2[i]) <= threshold;
+    }
+    return isEq;
+}
+
+#ifdef BEE_INCLUDE_GLM
+b8 fuzzy_eq(Vec2 const &v1, Vec2 const &v2, f32 t) { return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t); }
+b8 fuzzy_eq(Vec3 const &v1, Vec3 const &v2, f32 t) {
+    return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t) && fuzzy_eq(v1.z, v2.z, t);
+}
+b8 fuzzy_eq(Vec4 const &v1, Vec4 const &v2, f32 t) {
+    return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t) && fuzzy_eq(v1.z, v2.z, t) && fuzzy_eq(v1.w, v2.w, t);
+}
+#endif
+
+
+// ==============================================
+// ========== Scratch Allocator
+
+ScratchArena::ScratchArena(usize block_size) : m_block_size(block_size) {}
+
+void *ScratchArena::alloc(usize size, usize align) {
+    auto const try_block = [&](Block const &block) -> void * {
+        auto const base = recast(uintptr_t, block.data.get());
+        auto const start = (base + m_offset + align - 1) & ~as(uintptr_t, align - 1);
+        if (start + size > base + block.size) {
+            return nullptr;
+        }
+        m_offset = start - base + size;
+        return recast(void *, start);
+    };
+
+    // Reuse blocks kept from previous rewinds
+    for (; m_block < m_blocks.size(); ++m_block, m_offset = 0) {
+        if (auto *ptr = try_block(m_blocks[m_block])) {
+            return ptr;
+        }
+    }
+
+    // Out of blocks, big requests get a block of their own
+    auto const block_size = std::max(m_block_size, size + align);
+    m_blocks.push_back({ Uptr<u8[]>(new u8[block_size]), block_size });
+    m_block = m_blocks.size() - 1;
+    m_offset = 0;
+    return try_block(m_blocks.back());
+}
+
+ScratchArena::Mark ScratchArena::mark() const { return { m_block, m_offset }; }
+void ScratchArena::rewind(Mark mark) {
+    m_block = mark.block;
+    m_offset = mark.offset;
+}
+void ScratchArena::reset() { rewind({}); }
+
+usize ScratchArena::used() const {
+    usize bytes = m_offset;
+    for (usize i = 0; i < m_block && i < m_blocks.size(); ++i) {
+        bytes += m_blocks[i].size;
+    }
+    return bytes;
+}
+usize ScratchArena::capacity() const {
+    usize bytes = 0;
+    for (auto const &block : m_blocks) {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+ScratchArena &scratch() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+
+// ==============================================
+// ========== Pool Allocator
+
+namespace details {
+
+inline constexpr usize pool_class_step = 16;
+inline constexpr usize pool_class_count = 16; // Up to 256 bytes
+inline constexpr usize pool_slab_size = 64 << 10;
+inline constexpr u32 pool_batch = 64;
+
+struct PoolNode {
+    PoolNode *next = nullptr;
+};
+
+struct PoolCentral {
+    std::mutex mtx;
+    PoolNode *head = nullptr;
+    u32 count = 0;
+};
+
+// Leaked on purpose, thread caches may flush into it during shutdown
+inline PoolCentral *pool_centrals() {
+    static auto *centrals = new PoolCentral[pool_class_count];
+    return centrals;
+}
+
+struct PoolCache {
+    Arr<PoolNode *, pool_class_count> heads {};
+    Arr<u32, pool_class_count> counts {};
+
+    ~PoolCache() {
+        for (usize i = 0; i < pool_class_count; ++i) {
+            give(i, counts[i]);
+        }
+    }
+
+    // Move 'n' nodes from this cache to the central list
+    void give(usize cls, u32 n) {
+        if (n < 1 || !heads[cls]) {
+            return;
+        }
+        PoolNode *first = heads[cls];
+        PoolNode *last = first;
+        u32 moved = 1;
+        for (; moved < n && last->next; ++moved) {
+            last = last->next;
+        }
+        heads[cls] = last->next;
+        counts[cls] -= moved;
+
+        auto &central = pool_centrals()[cls];
+        std::lock_guard lock(central.mtx);
+        last->next = central.head;
+        central.head = first;
+        central.count += moved;
+    }
+
+    // Move a batch from the central list to this cache, carving a new slab if empty
+    void take(usize cls) {
+        usize const block_size = (cls + 1) * pool_class_step;
+        auto &central = pool_centrals()[cls];
+        std::lock_guard lock(central.mtx);
+        if (!central.head) {
+            auto *slab = static_cast<u8 *>(::operator new(pool_slab_size, std::align_val_t(pool_class_step)));
+            for (usize offset = 0; offset + block_size <= pool_slab_size; offset += block_size) {
+                auto *node = recast(PoolNode *, slab + offset);
+                node->next = central.head;
+                central.head = node;
+                central.count++;
+            }
+        }
+        while (central.head && counts[cls] < pool_batch) {
+            PoolNode *node = central.head;
+            central.head = node->next;
+            central.count--;
+            node->next = heads[cls];
+            heads[cls] = node;
+            counts[cls]++;
+        }
+    }
+};
+
+inline PoolCache &pool_cache() {
+    thread_local PoolCache cache;
+    return cache;
+}
+
+inline b8 pool_fits(usize size, usize align) {
+    return size <= pool_class_step * pool_class_count && align <= pool_class_step;
+}
+inline usize pool_class(usize size) { return size < 1 ? 0 : (size - 1) / pool_class_step; }
+
+} // namespace details
+
+void *pool_alloc(usize size, usize align) {
+    if (!details::pool_fits(size, align)) {
+        return ::operator new(size, std::align_val_t(align));
+    }
+    usize const cls = details::pool_class(size);
+    auto &cache = details::pool_cache();
+    if (!cache.heads[cls]) {
+        cache.take(cls);
+    }
+    auto *node = cache.heads[cls];
+    cache.heads[cls] = node->next;
+    cache.counts[cls]--;
+    return node;
+}
+
+void pool_free(void *ptr, usize size, usize align) {
+    if (!ptr) {
+        return;
+    }
+    if (!details::pool_fits(size, align)) {
+        ::operator delete(ptr, std::align_val_t(align));
+        return;
+    }
+    usize const cls = details::pool_class(size);
+    auto &cache = details::pool_cache();
+    auto *node = static_cast<details::PoolNode *>(ptr);
+    node->next = cache.heads[cls];
+    cache.heads[cls] = node;
+    cache.counts[cls]++;
+    if (cache.counts[cls] > 2 * details::pool_batch) {
+        cache.give(cls, details::pool_batch);
+    }
+}
+
+
+// ==============================================
+// ========== Thread Pool
+
+namespace details {
+
+WorkDeque::WorkDeque(i64 capacity) {
+    m_rings.push_back(Unew<Ring>(capacity));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+}
+
+void WorkDeque::push(Job *job) {
+    i64 const b = m_bottom.load(std::memory_order_relaxed);
+    i64 const t = m_top.load(std::memory_order_acquire);
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    if (b - t > ring->capacity - 1) {
+        auto bigger = Unew<Ring>(ring->capacity * 2);
+        for (i64 i = t; i < b; ++i) {
+            bigger->put(i, ring->get(i));
+        }
+        ring = bigger.get();
+        m_rings.push_back(std::move(bigger));
+        m_ring.store(ring, std::memory_order_release);
+    }
+    ring->put(b, job);
+    m_bottom.store(b + 1, std::memory_order_release);
+}
+
+Job *WorkDeque::pop() {
+    i64 const b = m_bottom.load(std::memory_order_relaxed) - 1;
+    Ring *ring = m_ring.load(std::memory_order_relaxed);
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) { // Empty
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job *job = ring->get(b);
+    if (t == b) { // Last one, race against thieves
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job *WorkDeque::steal() {
+    i64 t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 const b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    Ring *ring = m_ring.load(std::memory_order_acquire);
+    Job *job = ring->get(t);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+struct WorkerInfo {
+    ThreadPool *pool = nullptr;
+    usize index = 0;
+    u32 seed = 0x9E3779B9;
+};
+inline WorkerInfo &worker_info() {
+    thread_local WorkerInfo info;
+    return info;
+}
+
+} // namespace details
+
+ThreadPool::ThreadPool(usize threads) {
+    if (threads < 1) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (usize i = 0; i < threads; ++i) {
+        m_deques.push_back(Unew<details::WorkDeque>());
+    }
+    for (usize i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { worker_main(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_sleep_mtx);
+        m_stop = true;
+    }
+    m_sleep_cv.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+usize ThreadPool::size() const { return m_threads.size(); }
+
+usize ThreadPool::grain_for(usize count) const {
+    usize const chunks = (size() + 1) * 4;
+    return std::max<usize>(1, (count + chunks - 1) / chunks);
+}
+
+b8 ThreadPool::run_one() {
+    auto *job = find_job();
+    if (!job) {
+        return false;
+    }
+    execute(job);
+    return true;
+}
+
+void ThreadPool::push(details::Job *job, b8 wake) {
+    auto const &info = details::worker_info();
+    if (info.pool == this) {
+        m_deques[info.index]->push(job);
+    } else {
+        std::lock_guard lock(m_injected_mtx);
+        m_injected.push_back(job);
+    }
+    m_queued.fetch_add(1);
+    if (wake && m_sleeping.load() > 0) {
+        std::lock_guard lock(m_sleep_mtx);
+        m_sleep_cv.notify_one();
+    }
+}
+
+void ThreadPool::wake_all() {
+    if (m_sleeping.load() > 0) {
+        std::lock_guard lock(m_sleep_mtx);
+        m_sleep_cv.notify_all();
+    }
+}
+
+void ThreadPool::execute(details::Job *job) {
+    b8 const owned = job->owned; // Non-owned jobs may be gone right after 'run'
+    job->run();
+    if (owned) {
+        delete job;
+    }
+}
+
+details::Job *ThreadPool::find_job() {
+    if (m_queued.load(std::memory_order_relaxed) < 1) {
+        return nullptr;
+    }
+    auto &info = details::worker_info();
+    b8 const is_worker = info.pool == this;
+
+    details::Job *job = is_worker ? m_deques[info.index]->pop() : nullptr;
+
+    // Steal starting from a random victim
+    if (!job) {
+        info.seed ^= info.seed << 13;
+        info.seed ^= info.seed >> 17;
+        info.seed ^= info.seed << 5;
+        usize const first = info.seed % m_deques.size();
+        for (usize i = 0; i < m_deques.size() && !job; ++i) {
+            usize const victim = (first + i) % m_deques.size();
+            if (!is_worker || victim != info.index) {
+                job = m_deques[victim]->steal();
+            }
+        }
+    }
+
+    if (!job) {
+        std::lock_guard lock(m_injected_mtx);
+        if (!m_injected.empty()) {
+            job = m_injected.front();
+            m_injected.pop_front();
+        }
+    }
+
+    if (job) {
+        m_queued.fetch_sub(1);
+    }
+    return job;
+}
+
+void ThreadPool::worker_main(usize index) {
+    auto &info = details::worker_info();
+    info.pool = this;
+    info.index = index;
+    info.seed += as(u32, index) * 0x85EBCA6B;
+
+    while (true) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock lock(m_sleep_mtx);
+        m_sleeping.fetch_add(1);
+        m_sleep_cv.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+        m_sleeping.fetch_sub(1);
+        if (m_stop && m_queued.load() < 1) {
+            return;
+        }
+    }
+}
+
+ThreadPool &thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+
+// ==============================================
+// ========== Task Graph
+
+TaskGraph::NodeId TaskGraph::add(Str name, Fn<void()> fn) {
+    m_dirty = true;
+    auto &node = m_nodes.emplace_back();
+    node.name = std::move(name);
+    node.fn = std::move(fn);
+    return as(NodeId, m_nodes.size() - 1);
+}
+
+void TaskGraph::precede(NodeId before, NodeId after) {
+    m_dirty = true;
+    m_nodes[before].successors.push_back(after);
+    m_nodes[after].predecessors++;
+}
+
+b8 TaskGraph::run(ThreadPool &pool) {
+    if (m_dirty && !prepare()) {
+        bee_err("[TaskGraph] Cycle detected, {} nodes", m_nodes.size());
+        return false;
+    }
+    if (m_nodes.empty()) {
+        return true;
+    }
+
+    ETimer timer;
+    timer.reset();
+
+    for (usize i = 0; i < m_nodes.size(); ++i) {
+        m_pending[i].store(m_nodes[i].predecessors, std::memory_order_relaxed);
+        m_jobs[i].pool = &pool;
+    }
+    m_remaining.store(as(u32, m_nodes.size()), std::memory_order_relaxed);
+
+    for (usize i = 1; i < m_roots.size(); ++i) {
+        pool.push(&m_jobs[m_roots[i]], false);
+    }
+    pool.wake_all();
+    execute(m_roots[0], pool);
+    pool.wait_until([this] { return m_remaining.load(std::memory_order_acquire) == 0; });
+    m_error.rethrow();
+
+    m_elapsed_ns = timer.elapsed_ns();
+    prioritize();
+    return true;
+}
+
+usize TaskGraph::size() const { return m_nodes.size(); }
+Str const &TaskGraph::name(NodeId node) const { return m_nodes[node].name; }
+
+f64 TaskGraph::elapsed_ms() const { return m_elapsed_ns * ns_to_ms; }
+f64 TaskGraph::elapsed_ms(NodeId node) const { return m_nodes[node].elapsed_ns * ns_to_ms; }
+
+Vec<TaskGraph::NodeId> TaskGraph::critical_path() const {
+    Vec<NodeId> path;
+    NodeId node = m_roots.empty() || m_dirty ? npos : m_roots[0];
+    while (node != npos) {
+        path.push_back(node);
+        auto const &successors = m_nodes[node].successors;
+        node = successors.empty() ? npos : successors[0];
+    }
+    return path;
+}
+
+b8 TaskGraph::prepare() {
+    // Kahn's algorithm
+    m_order.clear();
+    m_roots.clear();
+    Vec<u32> pending(m_nodes.size());
+    for (usize i = 0; i < m_nodes.size(); ++i) {
+        pending[i] = m_nodes[i].predecessors;
+        if (pending[i] == 0) {
+            m_order.push_back(as(NodeId, i));
+            m_roots.push_back(as(NodeId, i));
+        }
+    }
+    for (usize i = 0; i < m_order.size(); ++i) {
+        for (NodeId successor : m_nodes[m_order[i]].successors) {
+            if (--pending[successor] == 0) {
+                m_order.push_back(successor);
+            }
+        }
+    }
+    if (m_order.size() != m_nodes.size()) {
+        return false;
+    }
+
+    m_jobs.clear();
+    m_jobs.reserve(m_nodes.size());
+    for (usize i = 0; i < m_nodes.size(); ++i) {
+        m_jobs.emplace_back(this, as(NodeId, i));
+    }
+    m_pending.reset(new std::atomic<u32>[m_nodes.size()]);
+
+    prioritize();
+    m_dirty = false;
+    return true;
+}
+
+void TaskGraph::prioritize() {
+    // Longest path to a sink, nodes that never ran weight 1ns
+    for (auto it = m_order.rbegin(); it != m_order.rend(); ++it) {
+        auto &node = m_nodes[*it];
+        f64 tail = 0.;
+        for (NodeId successor : node.successors) {
+            tail = std::max(tail, m_nodes[successor].priority);
+        }
+        node.priority = std::max(node.elapsed_ns, 1.) + tail;
+    }
+    auto const by_priority = [this](NodeId a, NodeId b) { return m_nodes[a].priority > m_nodes[b].priority; };
+    for (auto &node : m_nodes) {
+        std::sort(node.successors.begin(), node.successors.end(), by_priority);
+    }
+    std::sort(m_roots.begin(), m_roots.end(), by_priority);
+}
+
+void TaskGraph::execute(NodeId id, ThreadPool &pool) {
+    while (id != npos) {
+        auto &node = m_nodes[id];
+
+        if (node.fn && !m_error.failed.load(std::memory_order_acquire)) {
+            ETimer timer;
+            timer.reset();
+            try {
+                node.fn();
+            } catch (...) {
+                m_error.capture();
+            }
+            node.elapsed_ns = timer.elapsed_ns();
+        }
+
+        // Keep the most critical ready successor on this thread, hand out the rest
+        NodeId next = npos;
+        for (NodeId successor : node.successors) {
+            if (m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                continue;
+            }
+            if (next == npos) {
+                next = successor;
+            } else {
+                pool.push(&m_jobs[successor]);
+            }
+        }
+
+        m_remaining.fetch_sub(1, std::memory_order_release);
+        id = next;
+    }
+}
+
+
+// ==============================================
+// ========== Coroutines
+
+#ifdef BEE_HAS_COROUTINES
+
+namespace details {
+
+// Named callables instead of lambdas, a lambda type has no linkage and can't live in a header's coroutine frame
+template <auto Fn, typename... Args>
+struct BoundCall {
+    [[nodiscard]] auto operator()() const { return std::apply(Fn, args); }
+    std::tuple<Args const &...> args;
+};
+
+} // namespace details
+
+Task<Str> file_read_async(Str input_file, ThreadPool &pool) {
+    using Read = details::BoundCall<static_cast<Str (*)(Str const &)>(file_read), Str>;
+    co_return co_await offload(Read { { input_file } }, pool);
+}
+Task<Vec<u8>> bin_read_async(Str path, ThreadPool &pool) {
+    using Read = details::BoundCall<static_cast<Vec<u8> (*)(Str const &)>(bin_read), Str>;
+    co_return co_await offload(Read { { path } }, pool);
+}
+Task<b8> file_write_append_async(Str output_file, Str to_write, ThreadPool &pool) {
+    using Write = details::BoundCall<static_cast<b8 (*)(Str const &, Str const &)>(file_write_append), Str, Str>;
+    co_return co_await offload(Write { { output_file, to_write } }, pool);
+}
+Task<b8> file_write_trunc_async(Str output_file, Str to_write, ThreadPool &pool) {
+    using Write = details::BoundCall<static_cast<b8 (*)(Str const &, Str const &)>(file_write_trunc), Str, Str>;
+    co_return co_await offload(Write { { output_file, to_write } }, pool);
+}
+
+#endif // BEE_HAS_COROUTINES
+
+// ==============================================
+// ========== Synchronization
+
+void Mutex::lock_slow(u32 state) {
+    Backoff backoff;
+    for (i32 i = 0; i < 8 && state == 1; ++i) { // Short spin, the owner might be about to leave
+        backoff.pause();
+        state = 0;
+        if (m_state.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    if (state != 2) {
+        state = m_state.exchange(2, std::memory_order_acquire);
+    }
+    while (state != 0) {
+#ifdef __linux__
+        syscall(SYS_futex, recast(u32 *, &m_state), FUTEX_WAIT_PRIVATE, 2, nullptr, nullptr, 0);
+#else
+        m_state.wait(2, std::memory_order_relaxed);
+#endif
+        state = m_state.exchange(2, std::memory_order_acquire);
+    }
+}
+
+void Mutex::wake_one() {
+#ifdef __linux__
+    syscall(SYS_futex, recast(u32 *, &m_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    m_state.notify_one();
+#endif
+}
+
+
+// ==============================================
+// ========== IoRing
+
+#ifdef BEE_HAS_POSIX_IO
+
+namespace details {
+
+#ifdef BEE_HAS_IO_URING
+
+// Minimal io_uring plumbing: the three shared mappings and their indices
+struct Uring {
+    bee_nocopy_nomove(Uring);
+
+    Uring() = default;
+    ~Uring() {
+        if (sqes) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    static Uptr<Uring> create(u32 entries) {
+        io_uring_params params {};
+        auto ring = Unew<Uring>();
+        ring->fd = as(i32, syscall(__NR_io_uring_setup, entries, &params));
+        if (ring->fd < 0) {
+            return nullptr;
+        }
+
+        ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+        ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        b8 const single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            ring->sq_ring_size = ring->cq_ring_size = std::max(ring->sq_ring_size, ring->cq_ring_size);
+        }
+
+        auto const map = [&](usize size, u64 offset) -> void * {
+            void *const addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                                    as(off_t, offset));
+            return addr == MAP_FAILED ? nullptr : addr;
+        };
+        ring->sq_ring = map(ring->sq_ring_size, IORING_OFF_SQ_RING);
+        ring->cq_ring = single_mmap ? ring->sq_ring : map(ring->cq_ring_size, IORING_OFF_CQ_RING);
+        ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = recast(io_uring_sqe *, map(ring->sqes_size, IORING_OFF_SQES));
+        if (!ring->sq_ring || !ring->cq_ring || !ring->sqes) {
+            return nullptr;
+        }
+
+        u8 *const sq = recast(u8 *, ring->sq_ring);
+        ring->sq_head = recast(u32 *, sq + params.sq_off.head);
+        ring->sq_tail = recast(u32 *, sq + params.sq_off.tail);
+        ring->sq_mask = *recast(u32 *, sq + params.sq_off.ring_mask);
+        ring->sq_array = recast(u32 *, sq + params.sq_off.array);
+        ring->sq_entries = params.sq_entries;
+        ring->local_tail = *ring->sq_tail;
+
+        u8 *const cq = recast(u8 *, ring->cq_ring);
+        ring->cq_head = recast(u32 *, cq + params.cq_off.head);
+        ring->cq_tail = recast(u32 *, cq + params.cq_off.tail);
+        ring->cq_mask = *recast(u32 *, cq + params.cq_off.ring_mask);
+        ring->cqes = recast(io_uring_cqe *, cq + params.cq_off.cqes);
+        ring->cq_entries = params.cq_entries;
+        return ring;
+    }
+
+    [[nodiscard]] b8 full() const {
+        return local_tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire) >= sq_entries;
+    }
+
+    // Null when the submission queue is full
+    io_uring_sqe *next_sqe() {
+        if (full()) {
+            return nullptr;
+        }
+        u32 const slot = local_tail & sq_mask;
+        io_uring_sqe *const sqe = &sqes[slot];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array[slot] = slot;
+        ++local_tail;
+        ++unsubmitted;
+        last = sqe;
+        return sqe;
+    }
+
+    // Entries the kernel took, or -errno (nothing was taken then)
+    i64 submit(u32 wait) {
+        std::atomic_ref(*sq_tail).store(local_tail, std::memory_order_release);
+        u32 const flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0;
+        while (true) {
+            i64 const submitted = syscall(__NR_io_uring_enter, fd, unsubmitted, wait, flags, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -errno;
+            }
+            unsubmitted -= as(u32, submitted);
+            last = nullptr; // Submitted entries can't be linked anymore
+            return submitted;
+        }
+    }
+
+    // Takes back the entries the kernel did not consume
+    template <typename F>
+    void retract(F &&on_sqe) {
+        u32 const head = std::atomic_ref(*sq_head).load(std::memory_order_acquire);
+        for (u32 i = head; i != local_tail; ++i) {
+            on_sqe(sqes[sq_array[i & sq_mask]]);
+        }
+        local_tail = head;
+        std::atomic_ref(*sq_tail).store(local_tail, std::memory_order_release);
+        unsubmitted = 0;
+        last = nullptr;
+    }
+
+    template <typename F>
+    void reap(F &&on_cqe) {
+        u32 head = *cq_head;
+        u32 const tail = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            on_cqe(cqes[head & cq_mask]);
+        }
+        std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+    }
+
+    i32 fd = -1;
+    void *sq_ring = nullptr;
+    void *cq_ring = nullptr;
+    io_uring_sqe *sqes = nullptr;
+    usize sq_ring_size = 0;
+    usize cq_ring_size = 0;
+    usize sqes_size = 0;
+
+    u32 *sq_head = nullptr;
+    u32 *sq_tail = nullptr;
+    u32 *sq_array = nullptr;
+    u32 sq_mask = 0;
+    u32 sq_entries = 0;
+    u32 local_tail = 0;
+    u32 unsubmitted = 0;
+    io_uring_sqe *last = nullptr;
+
+    u32 *cq_head = nullptr;
+    u32 *cq_tail = nullptr;
+    io_uring_cqe *cqes = nullptr;
+    u32 cq_mask = 0;
+    u32 cq_entries = 0;
+};
+
+#else
+struct Uring {};
+#endif // BEE_HAS_IO_URING
+
+inline void read_rest(IoRing &ring, i32 fd, Str &out, usize done, Str const &path) {
+    Span<u8> const rest(recast(u8 *, out.data()) + done, out.size() - done);
+    ring.read(fd, rest, done, [&ring, fd, &out, done, &path](i64 result) {
+        if (result > 0 && done + as(usize, result) < out.size()) {
+            read_rest(ring, fd, out, done + as(usize, result), path);
+            return;
+        }
+        if (result < 0) {
+            bee_err("[file_read_many] Reading file: {}", path);
+            out.clear();
+        } else if (result == 0) {
+            out.resize(done); // Shrunk since fstat
+        }
+        ::close(fd);
+    });
+}
+
+} // namespace details
+
+IoRing::IoRing(u32 entries, ThreadPool &pool, b8 allow_uring) : m_capacity(std::max(entries, 1u)), m_pool(pool) {
+#ifdef BEE_HAS_IO_URING
+    if (allow_uring) {
+        m_uring = details::Uring::create(m_capacity);
+        if (m_uring) {
+            m_capacity = m_uring->cq_entries; // In flight ops must always fit in the completion queue
+        }
+    }
+#else
+    (void)allow_uring;
+#endif
+}
+
+IoRing::~IoRing() { drain(); }
+
+void IoRing::read(i32 fd, Span<u8> buffer, u64 offset, IoCallback done) {
+    push({ .code = Code::Read, .fd = fd, .buffer = buffer.data(), .size = buffer.size(), .offset = offset },
+         std::move(done));
+}
+
+void IoRing::write(i32 fd, SpanConst<u8> data, u64 offset, IoCallback done) {
+    push({ .code = Code::Write,
+           .fd = fd,
+           .buffer = const_cast<u8 *>(data.data()),
+           .size = data.size(),
+           .offset = offset },
+         std::move(done));
+}
+
+void IoRing::fsync(i32 fd, IoCallback done) { push({ .code = Code::Fsync, .fd = fd }, std::move(done)); }
+
+b8 IoRing::register_buffers(SpanConst<Span<u8>> buffers) {
+    m_registered.assign(buffers.begin(), buffers.end());
+#ifdef BEE_HAS_IO_URING
+    if (m_uring) {
+        Vec<iovec> iov;
+        for (Span<u8> const buffer : buffers) {
+            iov.push_back({ buffer.data(), buffer.size() });
+        }
+        return syscall(__NR_io_uring_register, m_uring->fd, IORING_REGISTER_BUFFERS, iov.data(), iov.size()) == 0;
+    }
+#endif
+    return true;
+}
+
+void IoRing::read_fixed(i32 fd, u16 buffer_index, Span<u8> range, u64 offset, IoCallback done) {
+    push({ .code = Code::ReadFixed,
+           .buffer_index = buffer_index,
+           .fd = fd,
+           .buffer = range.data(),
+           .size = range.size(),
+           .offset = offset },
+         std::move(done));
+}
+
+void IoRing::link() {
+    if (m_link_cancelled) {
+        m_link_next = true; // Nothing queued to flag, the next op is cancelled in 'push'
+        return;
+    }
+    b8 queued = !m_queued.empty();
+#ifdef BEE_HAS_IO_URING
+    if (m_uring) {
+        queued = m_uring->last != nullptr;
+        if (queued) {
+            m_uring->last->flags |= IOSQE_IO_LINK;
+        }
+    }
+#endif
+    if (!queued) {
+        return;
+    }
+    if (!m_uring) {
+        m_queued.back().linked = true;
+    }
+    m_link_next = true;
+    m_link_cut = false;
+    m_link_result.reset();
+}
+
+void IoRing::push(Op const &op, IoCallback done) {
+    // Ops queued by callbacks while this one waits are not part of its chain
+    if (!std::exchange(m_link_next, false)) {
+        m_link_cancelled = false;
+    } else if (m_link_cancelled) {
+        fail(track(std::move(done)), -ECANCELED);
+        return;
+    } else {
+        b8 room = m_in_flight < m_capacity;
+#ifdef BEE_HAS_IO_URING
+        room &= !m_uring || !m_uring->full();
+#endif
+        if (!room) {
+            submit(); // Cuts the chain
+        }
+        if (m_link_cut) {
+            while (!m_link_result) {
+                wait(1);
+            }
+            i64 const previous = *m_link_result;
+            m_link_cut = false;
+            m_link_result.reset();
+            b8 const short_transfer =
+                    m_link_op.code != Code::Fsync && previous >= 0 && as(usize, previous) < m_link_op.size;
+            if (previous < 0 || short_transfer) {
+                m_link_cancelled = true;
+                fail(track(std::move(done)), -ECANCELED);
+                return;
+            }
+        }
     }
-    return str;
+
+    while (m_in_flight >= m_capacity) {
+        wait(1);
+    }
+    u32 const index = track(std::move(done));
+    m_last_op = op;
+    m_last_index = index;
+
+#ifdef BEE_HAS_IO_URING
+    if (m_uring) {
+        io_uring_sqe *sqe = m_uring->next_sqe();
+        if (!sqe) {
+            submit();
+            sqe = m_uring->next_sqe();
+        }
+        if (!sqe) {
+            fail(index, -EBUSY);
+            return;
+        }
+        sqe->fd = op.fd;
+        sqe->addr = recast(u64, op.buffer);
+        sqe->len = as(u32, op.size);
+        sqe->off = op.offset;
+        sqe->user_data = index;
+        switch (op.code) {
+            case Code::Read: sqe->opcode = IORING_OP_READ; break;
+            case Code::Write: sqe->opcode = IORING_OP_WRITE; break;
+            case Code::ReadFixed:
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->buf_index = op.buffer_index;
+                break;
+            case Code::Fsync: sqe->opcode = IORING_OP_FSYNC; break;
+        }
+        return;
+    }
+#endif
+    m_queued.push_back(op);
+    m_queued_indices.push_back(index);
 }
 
-Str str_cut(Str const &str, i32 count) { return str_cut_r(str_cut_l(str, count), count); }
-Str str_cut_l(Str const &str, i32 count) { return str.substr(count); }
-Str str_cut_r(Str const &str, i32 count) { return str.substr(0, std::max(i32(str.size()) - count, count)); }
+u32 IoRing::track(IoCallback done) {
+    u32 index = 0;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = as(u32, m_callbacks.size());
+        m_callbacks.emplace_back();
+    }
+    m_callbacks[index] = std::move(done);
+    ++m_in_flight;
+    return index;
+}
 
-Str str_trim(Str str, Str const &individual_chars_to_remove) {
-    auto const l = str_trim_l(str, individual_chars_to_remove);
-    return str_trim_r(l, individual_chars_to_remove);
+// Completes an op that never reached the kernel or the pool, on the next 'poll'
+void IoRing::fail(u32 index, i64 result) {
+    std::lock_guard lock(m_mtx);
+    m_completed.push_back({ index, result });
 }
-Str str_trim_l(Str str, Str const &individual_chars_to_remove) {
-    return str.erase(0, str.find_first_not_of(individual_chars_to_remove));
+
+void IoRing::fail_unsubmitted(i64 error) {
+#ifdef BEE_HAS_IO_URING
+    if (m_uring->unsubmitted > 0) {
+        bee_err("[IoRing] Submitting {} ops: {}", m_uring->unsubmitted, std::strerror(as(i32, -error)));
+        m_uring->retract([&](io_uring_sqe const &sqe) { fail(as(u32, sqe.user_data), error); });
+    }
+#else
+    (void)error;
+#endif
 }
-Str str_trim_r(Str str, Str const &individual_chars_to_remove) {
-    return str.erase(str.find_last_not_of(individual_chars_to_remove) + 1);
+
+// A link flag on the last queued op would reach past this submit, drop it
+// and let the next 'push' wait for that op instead
+void IoRing::cut_chain() {
+    b8 cut = false;
+#ifdef BEE_HAS_IO_URING
+    if (m_uring && m_uring->last && (m_uring->last->flags & IOSQE_IO_LINK)) {
+        m_uring->last->flags &= ~IOSQE_IO_LINK;
+        cut = true;
+    }
+#endif
+    if (!m_uring && !m_queued.empty() && m_queued.back().linked) {
+        m_queued.back().linked = false;
+        cut = true;
+    }
+    if (cut) {
+        m_link_cut = true;
+        m_link_op = m_last_op;
+        m_link_index = m_last_index;
+    }
 }
 
+u32 IoRing::submit() {
+    cut_chain();
+#ifdef BEE_HAS_IO_URING
+    if (m_uring) {
+        if (m_uring->unsubmitted == 0) {
+            return 0;
+        }
+        i64 const submitted = m_uring->submit(0);
+        if (submitted <= 0) {
+            fail_unsubmitted(submitted < 0 ? submitted : -EAGAIN);
+            return 0;
+        }
+        return as(u32, submitted);
+    }
+#endif
+    u32 const count = as(u32, m_queued.size());
+    usize begin = 0;
+    for (usize i = 0; i < m_queued.size(); ++i) {
+        if (m_queued[i].linked && i + 1 < m_queued.size()) {
+            continue;
+        }
+        Vec<Op> chain(m_queued.begin() + as(isize, begin), m_queued.begin() + as(isize, i) + 1);
+        Vec<u32> indices(m_queued_indices.begin() + as(isize, begin), m_queued_indices.begin() + as(isize, i) + 1);
+        m_pool.spawn([this, chain = std::move(chain), indices = std::move(indices)]() mutable {
+            run_chain(std::move(chain), std::move(indices));
+        });
+        begin = i + 1;
+    }
+    m_queued.clear();
+    m_queued_indices.clear();
+    return count;
+}
 
-// ==============================================
-// ========== Binary Utils
+void IoRing::run_chain(Vec<Op> chain, Vec<u32> indices) {
+    Vec<Completion> done;
+    b8 cancelled = false;
+    for (usize i = 0; i < chain.size(); ++i) {
+        Op const &op = chain[i];
+        i64 result = -ECANCELED;
+        if (!cancelled) {
+            switch (op.code) {
+                case Code::Read:
+                case Code::ReadFixed: result = ::pread(op.fd, op.buffer, op.size, as(off_t, op.offset)); break;
+                case Code::Write: result = ::pwrite(op.fd, op.buffer, op.size, as(off_t, op.offset)); break;
+                case Code::Fsync: result = ::fsync(op.fd); break;
+            }
+            result = result < 0 ? -errno : result;
+        }
+        b8 const short_transfer = op.code != Code::Fsync && result >= 0 && as(usize, result) < op.size;
+        cancelled |= op.linked && (result < 0 || short_transfer);
+        done.push_back({ indices[i], result });
+    }
+    // Last touch of the ring: once the owner sees these it may destroy it
+    std::lock_guard lock(m_mtx);
+    m_completed.insert(m_completed.end(), done.begin(), done.end());
+}
 
-Vec<u8> bin_read(Str const &path) {
-    std::ifstream file { path, std::ios::binary };
-    auto fileBegin = std::istreambuf_iterator<char>(file);
-    auto fileEnd = std::istreambuf_iterator<char>();
-    return { fileBegin, fileEnd };
+u32 IoRing::poll() {
+    Vec<Completion> completions;
+#ifdef BEE_HAS_IO_URING
+    if (m_uring) {
+        m_uring->reap([&](io_uring_cqe const &cqe) { completions.push_back({ as(u32, cqe.user_data), cqe.res }); });
+    }
+#endif
+    {
+        std::lock_guard lock(m_mtx);
+        completions.insert(completions.end(), m_completed.begin(), m_completed.end());
+        m_completed.clear();
+    }
+    complete(completions);
+    return as(u32, completions.size());
 }
 
-b8 bin_check_magic(SpanConst<u8> bin, SpanConst<u8> magic) {
-    // Validation
-    if (magic.empty() || bin.size() < magic.size()) {
-        return false;
+void IoRing::complete(Vec<Completion> &completions) {
+    for (Completion const &completion : completions) {
+        if (m_link_cut && !m_link_result && completion.index == m_link_index) {
+            m_link_result = completion.result;
+        }
+        IoCallback done = std::move(m_callbacks[completion.index]);
+        m_callbacks[completion.index] = nullptr;
+        m_free.push_back(completion.index);
+        --m_in_flight;
+        if (done) {
+            done(completion.result);
+        }
     }
-    // Iteration
-    b8 match = true;
-    for (usize i = 0; i < magic.size(); ++i) {
-        match &= (bin[i] == magic[i]);
+}
+
+u32 IoRing::wait(u32 count) {
+    u32 done = 0;
+    while (true) {
+        submit(); // Callbacks may have queued more
+        done += poll();
+        if (done >= count || m_in_flight == 0) {
+            return done;
+        }
+#ifdef BEE_HAS_IO_URING
+        if (m_uring) {
+            i64 const submitted = m_uring->submit(1);
+            if (submitted < 0) {
+                fail_unsubmitted(submitted);
+            }
+            continue;
+        }
+#endif
+        // Helps the pool rather than sleeping, the chains may be queued behind this very thread
+        m_pool.wait_until([&] {
+            std::lock_guard lock(m_mtx);
+            return !m_completed.empty();
+        });
+    }
+}
+
+void IoRing::drain() {
+    while (m_in_flight > 0) {
+        wait(m_in_flight);
     }
-    // Result
-    return match;
 }
 
+Vec<Str> file_read_many(SpanConst<Str> paths, IoRing &ring) {
+    Vec<Str> contents(paths.size());
+    for (usize i = 0; i < paths.size(); ++i) {
+        i32 const fd = ::open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            bee_err("[file_read_many] Opening file: {}", paths[i]);
+            continue;
+        }
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            continue;
+        }
+        contents[i].resize(as(usize, info.st_size));
+        details::read_rest(ring, fd, contents[i], 0, paths[i]);
+    }
+    ring.drain();
+    return contents;
+}
+
+#endif // BEE_HAS_POSIX_IO
+
 
 // ==============================================
-// ========== Files Utils
+// ========== Directory Utils
 
-Str file_read(Str const &input_file) {
-    std::ifstream file(input_file, std::ios::ate | std::ios::binary);
-    defer(file.close());
+namespace details {
 
-    if (!file.is_open()) {
-        return "";
-        bee_err("Issues opening file [r]: {}", input_file);
+class DirScan {
+public:
+    DirScan(DirScanOptions const &options, ThreadPool &pool) : m_options(options), m_pool(pool) {}
+
+    // Visit jobs point at this scan, it can't unwind before all of them ran
+    Vec<Str> run(fs::path const &root) {
+        enqueue(root);
+        m_pool.wait_until([&] { return m_pending.load(std::memory_order_acquire) == 0; });
+        m_error.rethrow();
+        std::sort(m_files.begin(), m_files.end());
+        return std::move(m_files);
     }
 
-    Str content;
-    content.resize(file.tellg());
-    file.seekg(0, std::ios::beg);
-    file.read(&content[0], content.size());
+private:
+    void enqueue(fs::path const &dir) {
+        if (m_options.follow_symlinks) {
+            std::error_code ec;
+            Str key = fs::canonical(dir, ec).string();
+            std::lock_guard lock(m_mtx);
+            if (ec || !m_visited.insert(std::move(key)).second) {
+                return;
+            }
+        }
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            m_pool.spawn([this, dir] { visit(dir); });
+        } catch (...) {
+            m_pending.fetch_sub(1, std::memory_order_release);
+            throw;
+        }
+    }
 
-    return content;
-}
+    void visit(fs::path const &dir) {
+        try {
+            list(dir);
+        } catch (...) {
+            m_error.capture();
+        }
+        m_pending.fetch_sub(1, std::memory_order_release);
+    }
 
-b8 file_write(Str const &output_file, char const *data, usize data_size, std::ios_base::openmode mode) {
-    if (!data || data_size < 1) {
+    void list(fs::path const &dir) {
+        auto const dir_options = fs::directory_options::skip_permission_denied |
+                                 (m_options.follow_symlinks ? fs::directory_options::follow_directory_symlink
+                                                            : fs::directory_options::none);
+        Vec<Str> found;
+        std::error_code ec;
+        fs::directory_iterator it(dir, dir_options, ec);
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            fs::directory_entry const &entry = *it;
+            if (!m_options.include_hidden && entry.path().filename().string().starts_with('.')) {
+                continue;
+            }
+            std::error_code status_ec;
+            if (entry.is_directory(status_ec) && (m_options.follow_symlinks || !entry.is_symlink(status_ec))) {
+                if (m_options.recursive) {
+                    enqueue(entry.path());
+                }
+                continue;
+            }
+            if (!entry.is_regular_file(status_ec) || (!m_options.follow_symlinks && entry.is_symlink(status_ec))) {
+                continue;
+            }
+            Str path = entry.path().string();
+            if (matches(path)) {
+                found.push_back(std::move(path));
+            }
+        }
+        if (ec) {
+            bee_err("[dir_scan] Listing directory: {}", dir.string());
+        }
+
+        if (!found.empty()) {
+            std::lock_guard lock(m_mtx);
+            m_files.insert(m_files.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+        }
+    }
+
+    [[nodiscard]] b8 matches(Str const &path) const {
+        if (m_options.extensions.empty()) {
+            return true;
+        }
+        for (Str const &ext : m_options.extensions) {
+            if (file_check_extension(path, ext.starts_with('.') ? ext.substr(1) : ext)) {
+                return true;
+            }
+        }
         return false;
-        bee_err("[file_write] Invalid data: {}", output_file);
     }
 
-    std::ofstream file(output_file, std::ios::out | std::ios::binary | mode);
-    defer(file.close());
+    DirScanOptions const &m_options;
+    ThreadPool &m_pool;
+    std::atomic<usize> m_pending = 0;
+    JobError m_error;
+    std::mutex m_mtx;
+    Vec<Str> m_files;
+    Uset<Str> m_visited;
+};
 
-    if (!file.is_open()) {
-        return false;
-        bee_err("[file_write] Opening file: {}", output_file);
+// Up to 'size' bytes of the file into 'data', -1 on error
+inline isize read_into(Str const &path, char *data, usize size) {
+    i32 const fd = fd_open_read(path);
+    if (fd < 0) {
+        return -1;
+    }
+    defer(fd_close(fd));
+    usize filled = 0;
+    while (filled < size) {
+        isize const n = fd_read(fd, data + filled, size - filled);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        filled += as(usize, n);
+    }
+    return as(isize, filled);
+}
+
+} // namespace details
+
+Vec<Str> dir_scan(Str const &root, DirScanOptions const &options, ThreadPool &pool) {
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        bee_err("[dir_scan] Not a directory: {}", root);
+        return {};
+    }
+    details::DirScan scan(options, pool);
+    return scan.run(root);
+}
+
+b8 files_load(SpanConst<Str> paths, Vec<Str> &out, ThreadPool &pool) {
+    out.resize(paths.size());
+    std::atomic<b8> ok = true;
+    pool.parallel_for(0, paths.size(), [&](usize i) {
+        if (!file_read(paths[i], out[i])) {
+            ok.store(false, std::memory_order_relaxed);
+        }
+    });
+    return ok;
+}
+
+b8 files_load(SpanConst<Str> paths, ScratchArena &arena, Vec<std::string_view> &out, ThreadPool &pool) {
+    Vec<usize> sizes(paths.size());
+    pool.parallel_for(0, paths.size(), [&](usize i) {
+        std::error_code ec;
+        sizes[i] = as(usize, fs::file_size(paths[i], ec));
+        sizes[i] = ec ? 0 : sizes[i];
+    });
+
+    // The arena is not thread-safe, carve every slot before reading. One spare
+    // byte per slot tells a file that grew from one read exactly to its end.
+    out.resize(paths.size());
+    for (usize i = 0; i < paths.size(); ++i) {
+        out[i] = { recast(char *, arena.alloc(sizes[i] + 1, 1)), sizes[i] + 1 };
+    }
+
+    std::atomic<b8> ok = true;
+    Vec<Opt<Str>> reread(paths.size());
+    pool.parallel_for(0, paths.size(), [&](usize i) {
+        isize read = 0;
+        if (sizes[i] > 0) {
+            read = details::read_into(paths[i], const_cast<char *>(out[i].data()), out[i].size());
+        }
+        if (read < 0) {
+            bee_err("[files_load] Reading file: {}", paths[i]);
+            ok.store(false, std::memory_order_relaxed);
+        }
+        if (sizes[i] == 0 || as(usize, read) == out[i].size()) {
+            reread[i].emplace();
+            if (!file_read(paths[i], *reread[i])) {
+                ok.store(false, std::memory_order_relaxed);
+            }
+        }
+        out[i] = out[i].substr(0, read < 0 ? 0 : std::min(as(usize, read), sizes[i])); // Shrunk since it was sized
+    });
+
+    for (usize i = 0; i < paths.size(); ++i) {
+        if (reread[i]) {
+            char *const data = recast(char *, arena.alloc(reread[i]->size(), 1));
+            std::memcpy(data, reread[i]->data(), reread[i]->size());
+            out[i] = { data, reread[i]->size() };
+        }
     }
+    return ok;
+}
 
-    file.write(data, data_size);
 
+// ==============================================
+// ========== File Cache
+
+namespace details {
+
+inline b8 file_stamp(Str const &path, FileStamp &stamp) {
+#ifdef BEE_HAS_POSIX_IO
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+#ifdef __APPLE__
+    timespec const mtime = info.st_mtimespec;
+#else
+    timespec const mtime = info.st_mtim;
+#endif
+    stamp.mtime_ns = as(i64, mtime.tv_sec) * 1'000'000'000 + mtime.tv_nsec;
+    stamp.size = as(u64, info.st_size);
+    stamp.inode = as(u64, info.st_ino);
+    stamp.device = as(u64, info.st_dev);
+    return true;
+#else
+    std::error_code ec;
+    auto const mtime = fs::last_write_time(path, ec);
+    auto const size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    stamp.mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+    stamp.size = as(u64, size);
     return true;
+#endif
 }
-b8 file_write_append(Str const &output_file, Str const &to_write) {
-    return file_write(output_file, to_write.data(), to_write.size(), std::ios::app);
+
+} // namespace details
+
+FileCache::FileCache(FileCacheOptions options) : m_cache(options.budget_bytes) {
+#ifdef __linux__
+    if (!options.watch) {
+        return;
+    }
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotify < 0 || m_wake < 0) {
+        bee_err("[FileCache] Can't watch files, falling back to stat");
+        if (m_inotify >= 0) {
+            ::close(m_inotify);
+        }
+        m_inotify = -1;
+        return;
+    }
+    m_watcher = std::thread([this] { watch_loop(); });
+#endif
 }
-b8 file_write_trunc(Str const &output_file, Str const &to_write) {
-    return file_write(output_file, to_write.data(), to_write.size(), std::ios::trunc);
+
+FileCache::~FileCache() {
+#ifdef __linux__
+    if (m_watcher.joinable()) {
+        u64 const one = 1;
+        (void)::write(m_wake, &one, sizeof(one));
+        m_watcher.join();
+    }
+    if (m_inotify >= 0) {
+        ::close(m_inotify);
+    }
+    if (m_wake >= 0) {
+        ::close(m_wake);
+    }
+#endif
 }
-b8 file_write_append(Str const &output_file, const char *data, usize data_size) {
-    return file_write(output_file, data, data_size, std::ios::app);
+
+Sptr<MappedFile const> FileCache::get(Str const &path) {
+    if (Opt<Entry> cached = m_cache.get(path)) {
+        details::FileStamp stamp;
+        if (cached->watched || (details::file_stamp(path, stamp) && stamp == cached->stamp)) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return cached->file;
+        }
+        m_stale.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    return load(path);
 }
-b8 file_write_trunc(Str const &output_file, const char *data, usize data_size) {
-    return file_write(output_file, data, data_size, std::ios::trunc);
+
+Sptr<MappedFile const> FileCache::load(Str const &path) {
+    // Watch before reading, so a change while loading can't go unnoticed
+    u64 const watch_id = watch(path);
+    b8 const watched = watch_id != 0;
+
+    details::FileStamp stamp;
+    if (!details::file_stamp(path, stamp)) { // Stamped before mapping, a change in between only costs a reload
+        bee_err("[FileCache] Not a readable file: {}", path);
+        m_cache.erase(path);
+        return nullptr;
+    }
+    auto file = Snew<MappedFile>(path, MapHint::Copy);
+    if (!file->is_open()) {
+        m_cache.erase(path);
+        return nullptr;
+    }
+
+    usize const cost = file->size() + path.size() + sizeof(Entry);
+    m_cache.put(path, Entry { file, stamp, watched }, cost);
+    if (watched && !still_watched(path, watch_id)) {
+        m_cache.erase(path); // The watch was dropped meanwhile, its drop may have missed this entry
+    }
+    return file;
 }
 
-b8 file_check_extension(Str const &input_file, Str ext) {
-    auto to_check = input_file.substr(input_file.find_last_of('.') + 1);
-    std::transform(to_check.begin(), to_check.end(), to_check.begin(), ::tolower);
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    return to_check == ext;
+b8 FileCache::invalidate(Str const &path) { return m_cache.erase(path); }
+
+void FileCache::clear() {
+    // Watches go first: a load racing with this sees its watch gone and drops
+    // its entry, instead of keeping one no watch covers anymore
+    (void)unwatch_all();
+    m_cache.clear();
+}
+
+FileCacheStats FileCache::stats() const {
+    return {
+        .hits = m_hits.load(std::memory_order_relaxed),
+        .misses = m_misses.load(std::memory_order_relaxed),
+        .stale = m_stale.load(std::memory_order_relaxed),
+        .invalidations = m_invalidations.load(std::memory_order_relaxed),
+        .evictions = m_cache.stats().evictions,
+    };
+}
+
+f64 FileCache::hit_rate() const {
+    FileCacheStats const s = stats();
+    u64 const lookups = s.hits + s.misses + s.stale;
+    return lookups > 0 ? as(f64, s.hits) / as(f64, lookups) : 0.0;
+}
+
+// Id of the watch covering 'path', 0 when it can't be watched
+u64 FileCache::watch(Str const &path) {
+#ifdef __linux__
+    if (!watching()) {
+        return 0;
+    }
+    std::lock_guard lock(m_watch_mtx);
+    if (m_watch_failed.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    if (auto const it = m_watches.find(path); it != m_watches.end()) {
+        return it->second;
+    }
+    constexpr u32 mask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+    i32 const wd = inotify_add_watch(m_inotify, path.c_str(), mask);
+    if (wd < 0) {
+        return 0; // Out of watches most likely, this entry uses stat
+    }
+    m_watches[path] = ++m_last_watch_id;
+    m_watched_paths[wd].push_back(path);
+    return m_last_watch_id;
+#else
+    (void)path;
+    return 0;
+#endif
+}
+
+b8 FileCache::still_watched(Str const &path, u64 watch_id) {
+    std::lock_guard lock(m_watch_mtx);
+    auto const it = m_watches.find(path);
+    return it != m_watches.end() && it->second == watch_id;
+}
+
+// Removes every watch, returns the paths whose entries relied on one
+Vec<Str> FileCache::unwatch_all() {
+    Vec<Str> paths;
+#ifdef __linux__
+    {
+        std::lock_guard lock(m_watch_mtx);
+        for (auto &[wd, wd_paths] : m_watched_paths) {
+            inotify_rm_watch(m_inotify, wd);
+            for (Str &path : wd_paths) {
+                paths.push_back(std::move(path));
+            }
+        }
+        m_watches.clear();
+        m_watched_paths.clear();
+    }
+#endif
+    return paths;
+}
+
+void FileCache::watch_loop() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        pollfd fds[2] = { { m_inotify, POLLIN, 0 }, { m_wake, POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            bee_err("[FileCache] Watching files failed, falling back to stat");
+            m_watch_failed.store(true, std::memory_order_relaxed);
+            for (Str const &path : unwatch_all()) {
+                m_cache.erase(path);
+            }
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        isize const length = ::read(m_inotify, buffer, sizeof(buffer));
+        for (isize offset = 0; offset < length;) {
+            auto const *event = recast(inotify_event const *, buffer + offset);
+            offset += as(isize, sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) { // Changes were lost, none of the watched entries can be trusted
+                bee_err("[FileCache] Watcher queue overflowed, dropping watched entries");
+                for (Str const &path : unwatch_all()) {
+                    m_cache.erase(path);
+                }
+                continue;
+            }
+
+            Vec<Str> paths;
+            {
+                std::lock_guard lock(m_watch_mtx);
+                auto const it = m_watched_paths.find(event->wd);
+                if (it == m_watched_paths.end()) {
+                    continue; // Already handled, or removed by 'clear'
+                }
+                paths = std::move(it->second);
+                m_watched_paths.erase(it);
+                for (Str const &path : paths) {
+                    m_watches.erase(path);
+                }
+                if (!(event->mask & IN_IGNORED)) {
+                    inotify_rm_watch(m_inotify, event->wd);
+                }
+            }
+            u64 dropped = 0;
+            for (Str const &path : paths) {
+                dropped += m_cache.erase(path) ? 1 : 0;
+            }
+            m_invalidations.fetch_add(dropped, std::memory_order_relaxed);
+        }
+    }
+#endif
+}
+
+FileCache &file_cache() {
+    static FileCache cache;
+    return cache;
 }
 
 
 // ==============================================
-// ========== Math Utils
+// ========== File Watcher
+
+FileWatcher::FileWatcher(i64 debounce_ms) : m_debounce_ns(std::max<i64>(debounce_ms, 0) * 1'000'000) {
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotify < 0 || m_wake < 0) {
+        bee_err("[FileWatcher] Can't create the inotify instance");
+        return;
+    }
+    m_thread = std::thread([this] { run(); });
+#else
+    bee_err("[FileWatcher] Only available on Linux");
+#endif
+}
 
-f32 map(f32 value, f32 srcMin, f32 srcMax, f32 dstMin, f32 dstMax) {
-    return dstMin + (dstMax - dstMin) * (value - srcMin) / (srcMax - srcMin);
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_thread.joinable()) {
+        u64 const one = 1;
+        (void)::write(m_wake, &one, sizeof(one));
+        m_thread.join();
+    }
+    if (m_inotify >= 0) {
+        ::close(m_inotify); // Drops every watch
+    }
+    if (m_wake >= 0) {
+        ::close(m_wake);
+    }
+#endif
 }
-f32 map_100(f32 value, f32 dstMin, f32 dstMax) { return map(value, 0, 100, dstMin, dstMax); }
 
-b8 fuzzy_eq(f32 f1, f32 f2, f32 threshold) {
-    auto const diff = abs(f1 - f2);
-    auto const isEq = diff <= threshold;
-    return isEq;
+WatchId FileWatcher::watch(Str const &path, FileWatchCallback callback) {
+#ifdef __linux__
+    if (!is_running()) {
+        return 0;
+    }
+    std::error_code ec;
+    fs::path const target(path);
+    b8 const is_dir = fs::is_directory(target, ec);
+    // One spelling per directory ("dir", "dir/" and "./dir" share a wd), so reported paths don't depend on the caller
+    fs::path dir_path = (is_dir ? target : target.parent_path()).lexically_normal();
+    if (!dir_path.has_filename() && dir_path.has_relative_path()) {
+        dir_path = dir_path.parent_path(); // Trailing separator
+    }
+    Str const dir = dir_path.empty() ? "." : dir_path.string();
+
+    constexpr u32 mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO |
+                         IN_ONLYDIR;
+    std::lock_guard lock(m_mtx);
+    i32 const wd = inotify_add_watch(m_inotify, dir.c_str(), mask); // Same directory, same wd
+    if (wd < 0) {
+        bee_err("[FileWatcher] Can't watch: {}", path);
+        return 0;
+    }
+    WatchId const id = m_next_id++;
+    Directory &directory = m_directories[wd];
+    if (directory.path.empty()) {
+        directory.path = dir; // Kept, another spelling (e.g. through a link) would rename reported paths
+    }
+    directory.ids.push_back(id);
+    m_subscriptions[id] = { wd, is_dir ? "" : target.filename().string(), std::move(callback) };
+    return id;
+#else
+    (void)path;
+    (void)callback;
+    return 0;
+#endif
 }
 
-f32 clamp_angle(f32 angle) {
-    auto const turns = floorf(angle / 360.f);
-    return angle - 360.f * turns;
+b8 FileWatcher::unwatch(WatchId id) {
+    std::lock_guard lock(m_mtx);
+    auto const it = m_subscriptions.find(id);
+    if (it == m_subscriptions.end()) {
+        return false;
+    }
+    i32 const wd = it->second.wd;
+    m_subscriptions.erase(it);
+
+    auto const dir = m_directories.find(wd);
+    if (dir != m_directories.end()) {
+        std::erase(dir->second.ids, id);
+        if (dir->second.ids.empty()) {
+#ifdef __linux__
+            inotify_rm_watch(m_inotify, wd);
+#endif
+            m_directories.erase(dir);
+        }
+    }
+    return true;
 }
 
-#ifdef BEE_INCLUDE_GLM
-b8 fuzzy_eq(Vec2 const &v1, Vec2 const &v2, f32 t) { return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t); }
-b8 fuzzy_eq(Vec3 const &v1, Vec3 const &v2, f32 t) {
-    return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t) && fuzzy_eq(v1.z, v2.z, t);
+void FileWatcher::queue(WatchId id, Str const &path, FileEvent events) {
+    i64 const now = mono_now_ns();
+    for (Pending &pending : m_pending) {
+        if (pending.id == id && pending.path == path) {
+            pending.events = pending.events | events;
+            pending.due_ns = std::min(now + m_debounce_ns, pending.first_ns + 10 * m_debounce_ns);
+            return;
+        }
+    }
+    m_pending.push_back({ id, path, events, now, now + m_debounce_ns });
 }
-b8 fuzzy_eq(Vec4 const &v1, Vec4 const &v2, f32 t) {
-    return fuzzy_eq(v1.x, v2.x, t) && fuzzy_eq(v1.y, v2.y, t) && fuzzy_eq(v1.z, v2.z, t) && fuzzy_eq(v1.w, v2.w, t);
+
+// Every subscription of 'directory', at the path it watches
+void FileWatcher::queue_all(Directory const &directory, FileEvent events) {
+    for (WatchId const id : directory.ids) {
+        Str const &name = m_subscriptions.at(id).name;
+        queue(id, name.empty() ? directory.path : directory.path + "/" + name, events);
+    }
+}
+
+void FileWatcher::fire_due(i64 now_ns) {
+    auto const split = std::stable_partition(m_pending.begin(), m_pending.end(),
+                                             [&](Pending const &pending) { return pending.due_ns > now_ns; });
+    Vec<Pending> const due(std::make_move_iterator(split), std::make_move_iterator(m_pending.end()));
+    m_pending.erase(split, m_pending.end());
+
+    for (Pending const &pending : due) {
+        FileWatchCallback callback;
+        {
+            std::lock_guard lock(m_mtx);
+            auto const it = m_subscriptions.find(pending.id);
+            if (it == m_subscriptions.end()) {
+                continue; // Unwatched meanwhile
+            }
+            callback = it->second.callback;
+        }
+        if (callback) {
+            callback({ pending.path, pending.events }); // Unlocked, it may watch or unwatch
+        }
+    }
 }
+
+void FileWatcher::run() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        i32 timeout_ms = -1;
+        if (!m_pending.empty()) {
+            i64 due = m_pending.front().due_ns;
+            for (Pending const &pending : m_pending) {
+                due = std::min(due, pending.due_ns);
+            }
+            timeout_ms = as(i32, std::max<i64>(due - mono_now_ns() + 999'999, 0) / 1'000'000);
+        }
+
+        pollfd fds[2] = { { m_inotify, POLLIN, 0 }, { m_wake, POLLIN, 0 } };
+        if (::poll(fds, 2, timeout_ms) < 0 && errno != EINTR) {
+            bee_err("[FileWatcher] Polling failed, stopped watching");
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        isize const length = (fds[0].revents & POLLIN) ? ::read(m_inotify, buffer, sizeof(buffer)) : 0;
+        for (isize offset = 0; offset < length;) {
+            auto const *event = recast(inotify_event const *, buffer + offset);
+            offset += as(isize, sizeof(inotify_event) + event->len);
+
+            FileEvent events = FileEvent::None;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                events = events | FileEvent::Created;
+            }
+            if (event->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB)) {
+                events = events | FileEvent::Modified;
+            }
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                events = events | FileEvent::Removed;
+            }
+
+            std::lock_guard lock(m_mtx);
+            if (event->mask & IN_Q_OVERFLOW) { // Events were lost, anything may have changed
+                bee_err("[FileWatcher] Event queue overflowed, reporting every watch as modified");
+                for (auto const &[wd, directory] : m_directories) {
+                    queue_all(directory, FileEvent::Modified);
+                }
+                continue;
+            }
+            auto const dir = m_directories.find(event->wd);
+            if (dir == m_directories.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) { // The directory itself is gone
+                queue_all(dir->second, FileEvent::Removed);
+                m_directories.erase(dir);
+                continue;
+            }
+            Str const name = event->len > 0 ? Str(event->name) : Str();
+            for (WatchId const id : dir->second.ids) {
+                Str const &wanted = m_subscriptions.at(id).name;
+                if (events != FileEvent::None && !name.empty() && (wanted.empty() || wanted == name)) {
+                    queue(id, dir->second.path + "/" + name, events);
+                }
+            }
+        }
+        fire_due(mono_now_ns());
+    }
 #endif
+}
 
 } // namespace bee
 
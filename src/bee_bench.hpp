@@ -72,7 +72,8 @@ namespace bee::bench {
 
 namespace detail {
 
-void add(std::string const &name, int32_t times, std::function<void()> const &fn, const char *file, int line);
+void add(std::string const &name, int32_t times, std::function<void()> const &fn, const char *file, int line,
+         int64_t items = 0, int64_t bytes = 0);
 
 } // namespace detail
 
@@ -116,6 +117,13 @@ void run();
         return 0;                                                                                                      \
     }();
 
+// Same as 'BENCH' but also reports items/s and MB/s, 'items' and 'bytes' are per execution (0 to skip)
+#define BENCH_THROUGHPUT(name, times, items, bytes, ...)                                                               \
+    static inline int BEE_CONCAT(bench_case__, __LINE__) = [] {                                                        \
+        bee::bench::detail::add(name, times, [] { __VA_ARGS__; }, __FILE__, __LINE__, items, bytes);                   \
+        return 0;                                                                                                      \
+    }();
+
 
 // ############################################################################
 // #                                                                          #
@@ -175,11 +183,14 @@ struct Benchmark {
     std::function<void()> fn = nullptr;
     const char *file = "";
     int32_t line = -1;
+    int64_t items = 0;
+    int64_t bytes = 0;
 };
 inline std::vector<Benchmark> g_benchmarks;
 
-void add(std::string const &name, int32_t times, std::function<void()> const &fn, const char *file, int line) {
-    g_benchmarks.push_back({ name, times, fn, file, line });
+void add(std::string const &name, int32_t times, std::function<void()> const &fn, const char *file, int line,
+         int64_t items, int64_t bytes) {
+    g_benchmarks.push_back({ name, times, fn, file, line, items, bytes });
 }
 
 } // namespace detail
@@ -199,7 +210,7 @@ void run() {
     std::chrono::high_resolution_clock::time_point start;
     std::chrono::high_resolution_clock::time_point end;
 
-    for (auto const &[name, times, fn, file, line] : detail::g_benchmarks) {
+    for (auto const &[name, times, fn, file, line, items, bytes] : detail::g_benchmarks) {
 
 #ifndef BEE_BENCH_STDOUT_ENABLE
         detail::stdout_off();
@@ -222,6 +233,14 @@ void run() {
         std::cout << "⌚ " << name << " :: Executed " << times << " times in " //
                   << double(elapsed) * 1e-6 << " ms  ( " << file << ":" << line << " )\n";
 
+        double const seconds = double(elapsed) * 1e-9;
+        if (items > 0 && seconds > 0.) {
+            std::cout << "   ↳ " << double(items) * times / seconds << " items/s\n";
+        }
+        if (bytes > 0 && seconds > 0.) {
+            std::cout << "   ↳ " << double(bytes) * times / seconds / (1024. * 1024.) << " MB/s\n";
+        }
+
 #ifdef BEE_BENCH_STDOUT_ONCE
         fn();
         std::cout << "\n";
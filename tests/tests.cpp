@@ -12,7 +12,15 @@
 // #define BEE_CPP_INCLUDE_GLM
 #include "../src/bee.hpp"
 
+#include <cerrno>
 #include <iostream>
+#include <queue>
+#include <shared_mutex>
+
+#ifdef BEE_HAS_POSIX_IO
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 using namespace bee::TypeAlias_GLM;
@@ -140,6 +148,115 @@ TEST("TypeAlias Pointers", {
     CHECK("Sptr", a.i == sa->i && a.f == sa->f);
 });
 
+TEST("Pooled Pointers", {
+    static i32 alive = 0;
+    struct A {
+        i32 i = 0;
+        f32 f = 0.f;
+        A(i32 i, f32 f) : i(i), f(f) { ++alive; }
+        ~A() { --alive; }
+    };
+    {
+        Pptr<A> pa = Pnew<A>(42, 3.14159f);
+        CHECK("Pptr", pa->i == 42 && pa->f == 3.14159f && alive == 1);
+        Sptr<A> sa = PSnew<A>(7, 1.f);
+        Sptr<A> sb = sa;
+        CHECK("PSnew", sb->i == 7 && sa.use_count() == 2 && alive == 2);
+    }
+    CHECK("Destroyed", alive == 0);
+
+    void *first = bee::pool_alloc(24);
+    bee::pool_free(first, 24);
+    void *second = bee::pool_alloc(20);
+    CHECK("Reuse", second == first);
+    bee::pool_free(second, 20);
+
+    struct Throws {
+        Throws() { throw 1; }
+        u8 data[24];
+    };
+    void *block = bee::pool_alloc(sizeof(Throws), alignof(Throws));
+    bee::pool_free(block, sizeof(Throws), alignof(Throws));
+    b8 thrown = false;
+    try {
+        (void)Pnew<Throws>();
+    } catch (i32) {
+        thrown = true;
+    }
+    void *after = bee::pool_alloc(sizeof(Throws), alignof(Throws));
+    CHECK("Ctor Throws", thrown && after == block);
+    bee::pool_free(after, sizeof(Throws), alignof(Throws));
+
+    struct alignas(64) Wide {
+        u8 data[64];
+    };
+    auto wide = Pnew<Wide>();
+    CHECK("Over Aligned", recast(uintptr_t, wide.get()) % 64 == 0);
+
+    Vec<Pptr<A>> from_thread;
+    std::thread([&] {
+        for (i32 i = 0; i < 1000; ++i) {
+            from_thread.push_back(Pnew<A>(i, 0.f));
+        }
+    }).join();
+    CHECK("Cross Thread", from_thread[999]->i == 999 && alive == 1000);
+    from_thread.clear();
+    CHECK("Cross Thread Free", alive == 0);
+});
+
+TEST("Reference Counted Pointers", {
+    static i32 alive = 0;
+    struct A {
+        i32 i = 0;
+        A(i32 i) : i(i) { ++alive; }
+        ~A() { --alive; }
+    };
+    {
+        Rc<A> ra = Rnew<A>(42);
+        Rc<A> rb = ra;
+        CHECK("Rc", rb->i == 42 && (*ra).i == 42 && ra == rb);
+        CHECK("Rc Count", ra.use_count() == 2);
+        Rc<A> rc = std::move(rb);
+        CHECK("Rc Move", !rb && ra.use_count() == 2);
+        rc.reset();
+        CHECK("Rc Reset", !rc && ra.use_count() == 1 && alive == 1);
+    }
+    CHECK("Rc Destroyed", alive == 0);
+    {
+        Arc<A> aa = Anew<A>(7);
+        Vec<std::thread> threads;
+        for (i32 t = 0; t < 4; ++t) {
+            threads.emplace_back([aa] {
+                for (i32 i = 0; i < 1000; ++i) {
+                    Arc<A> copy = aa;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        CHECK("Arc Count", aa.use_count() == 1 && aa->i == 7);
+    }
+    CHECK("Arc Destroyed", alive == 0);
+
+    struct Maybe {
+        Maybe(b8 fail) {
+            if (fail) {
+                throw 1;
+            }
+        }
+        i32 value = 0;
+    };
+    Maybe *const freed = Rnew<Maybe>(false).get(); // Dangling, only compared
+    b8 thrown = false;
+    try {
+        (void)Rnew<Maybe>(true);
+    } catch (i32) {
+        thrown = true;
+    }
+    CHECK("Ctor Throws", thrown && Rnew<Maybe>(false).get() == freed);
+});
+
 
 // ==============================================
 // ========== Optionals
@@ -172,6 +289,67 @@ TEST("Elapsed Timer", {
     CHECK("After Reset", timer.elapsed_ms() * timer.is_valid() > 9);
 });
 
+TEST("Timer Wheel", {
+    bee::TimerWheel wheel(1, 0); // 1 tick per ns, starting at 0
+    Vec<std::pair<i64, u64>> fired;
+    auto const record = [&](bee::TimerId, u64 data) { fired.push_back({ wheel.now_ns(), data }); };
+
+    Arr<i64, 6> const delays = { 1, 255, 256, 70'000, 20'000'000, i64(1) << 34 };
+    Vec<bee::TimerId> ids;
+    for (usize i = 0; i < delays.size(); ++i) {
+        ids.push_back(wheel.schedule_in(delays[i], i));
+    }
+    bee::TimerId const cancelled = wheel.schedule_in(1000, 99);
+    CHECK("Cancel", wheel.cancel(cancelled) && !wheel.cancel(cancelled) && !wheel.pending(cancelled));
+    CHECK("Size", wheel.size() == delays.size());
+
+    b8 on_time = true;
+    for (usize i = 0; i < delays.size(); ++i) {
+        on_time &= wheel.advance(delays[i] - 1, record) == 0;
+        on_time &= wheel.advance(delays[i], record) == 1 && fired.back() == std::pair<i64, u64>(delays[i], i);
+        on_time &= !wheel.pending(ids[i]);
+    }
+    CHECK("Exact Expiry", on_time && fired.size() == delays.size() && wheel.size() == 0);
+
+    bee::TimerId const chained = wheel.schedule_in(10, 1);
+    usize const count = wheel.advance(wheel.now_ns() + 10, [&](bee::TimerId, u64 data) {
+        if (data < 5) {
+            wheel.schedule_in(10, data + 1);
+        }
+    });
+    CHECK("Reschedule In Callback", count == 1 && !wheel.pending(chained) && wheel.size() == 1);
+    CHECK("Fire Rescheduled", wheel.advance(wheel.now_ns() + 1000, record) == 1 && wheel.size() == 0);
+
+    bee::TimerWheel many(1, 0);
+    Vec<i64> deadlines(20'000);
+    for (usize i = 0; i < deadlines.size(); ++i) {
+        deadlines[i] = as(i64, (i * 2'654'435'761ull) % (1 << 20)) + 1;
+        auto const id = many.schedule_at(deadlines[i], i);
+        if (i % 3 == 0) {
+            many.cancel(id);
+            deadlines[i] = -1;
+        }
+    }
+    usize expired = 0;
+    b8 in_window = true;
+    for (i64 now = 0; now <= (1 << 20);) {
+        i64 const previous = now;
+        now += 1 + (now * 7919) % 4000;
+        expired += many.advance(now, [&](bee::TimerId, u64 i) {
+            in_window &= deadlines[i] > previous && deadlines[i] <= now;
+        });
+    }
+    CHECK("Batched Expiry", in_window && expired == deadlines.size() - 6'667 && many.size() == 0);
+
+    bee::TimerWheel ms; // 1ms ticks on the monotonic clock
+    auto const late = ms.schedule_in(50 * as(i64, bee::ms_to_ns), 0);
+    auto const soon = ms.schedule_in(1, 0); // Rounded up to the next tick
+    CHECK("Monotonic", ms.advance(bee::mono_now_ns(), record) == 0 && ms.pending(soon));
+    CHECK("Never Early", ms.advance(ms.now_ns() + as(i64, bee::ms_to_ns), record) == 1 && ms.pending(late));
+    ms.clear();
+    CHECK("Clear", ms.size() == 0 && !ms.pending(late) && ms.schedule_in(1, 0) != late);
+});
+
 
 // ==============================================
 // ========== String helpers/operations
@@ -242,6 +420,1141 @@ TEST("File/Bin Helpers", {
     CHECK("Magic", bee::bin_check_magic(bin_content, magic));
 
     CHECK("Extension", bee::file_check_extension("./to_file_write.bin", "BiN"));
+
+    Vec<u8> reused(1024, 0);
+    u8 const *const storage = reused.data();
+    CHECK("Read Into", bee::bin_read("./to_file_write.bin", reused) && reused == bin && reused.data() == storage);
+    Str text;
+    CHECK("Read Into Str", bee::file_read("./to_file_read.txt", text) && text == expected_content);
+    CHECK("Read Missing", !bee::file_read("./this_file_does_not_exist.txt", text) && text.empty());
+#ifdef __linux__
+    CHECK("Read Unsized", bee::file_read("/proc/self/status", text) && bee::str_contains(text, "Name:"));
+#endif
+});
+
+TEST("File Writer", {
+    auto const path = (bee::fs::temp_directory_path() / "bee_tests_writer.txt").string();
+    {
+        bee::FileWriter writer(path, bee::WriteMode::Trunc, { .every_bytes = 16 }, 32);
+        CHECK("Open", writer.is_open() && writer.write("hello ") && writer.write(Str("world\n")));
+        CHECK("Buffered", bee::file_read(path).empty() && writer.sync_count() == 0);
+        Arr<std::string_view, 3> const parts = { "a much longer line ", "that does not fit ", "in the buffer\n" };
+        CHECK("Writev", writer.writev(parts) && bee::file_read(path).size() == writer.bytes_written());
+        CHECK("Policy Bytes", writer.sync_count() == 1);
+
+        bee::FileWriter moved = std::move(writer);
+        CHECK("Move", !writer.is_open() && moved.write("tail") && moved.flush());
+        CHECK("Flush", bee::str_split(bee::file_read(path), "\n").back() == "tail");
+    }
+    CHECK("Content", bee::file_read(path) == "hello world\na much longer line that does not fit in the buffer\ntail");
+
+    bee::FileWriter append(path, bee::WriteMode::Append, { .on_close = true });
+    append.write("!");
+    CHECK("Close Syncs", append.close() && append.sync_count() == 1 && !append.write("x"));
+    CHECK("Append", bee::file_read(path).back() == '!');
+    CHECK("Open Missing Dir", !bee::FileWriter("/this/dir/does/not/exist.txt").is_open());
+    bee::fs::remove(path);
+});
+
+TEST("Durable Writes", {
+    auto const dir = bee::fs::temp_directory_path() / "bee_tests_durable";
+    bee::fs::remove_all(dir);
+    bee::fs::create_directories(dir);
+    auto const path = (dir / "state.json").string();
+
+    CHECK("Create", bee::file_write_atomic(path, "{ \"v\": 1 }") && bee::file_read(path) == "{ \"v\": 1 }");
+    bee::fs::permissions(path, bee::fs::perms::owner_read | bee::fs::perms::owner_write);
+    CHECK("Replace", bee::file_write_atomic(path, "{}") && bee::file_read(path) == "{}");
+    CHECK("Keeps Permissions",
+          bee::fs::status(path).permissions() == (bee::fs::perms::owner_read | bee::fs::perms::owner_write));
+    CHECK("Empty", bee::file_write_atomic(path, "") && bee::fs::file_size(path) == 0);
+    CHECK("Missing Dir", !bee::file_write_atomic((dir / "nope" / "x").string(), "x"));
+    CHECK("No Leftovers", std::distance(bee::fs::directory_iterator(dir), bee::fs::directory_iterator()) == 1);
+
+    Str big(3 * 1024 * 1024 + 7, 0);
+    for (usize i = 0; i < big.size(); ++i) {
+        big[i] = as(char, bee::hash_u64(i));
+    }
+    auto const source = (dir / "big.bin").string();
+    auto const copy = (dir / "copy.bin").string();
+    (void)bee::file_write_trunc(source, big);
+    (void)bee::file_write_trunc(copy, big + big); // Longer, must be truncated
+    CHECK("Copy", bee::file_copy(source, copy) && bee::file_read(copy) == big);
+    CHECK("Copy Empty", bee::file_copy(path, copy) && bee::fs::file_size(copy) == 0);
+    CHECK("Copy Missing", !bee::file_copy((dir / "nope.bin").string(), copy));
+    CHECK("Copy Onto Itself", !bee::file_copy(source, source) && bee::file_read(source) == big);
+    auto const link = (dir / "link.bin").string();
+    bee::fs::create_hard_link(source, link);
+    CHECK("Copy Onto Hard Link", !bee::file_copy(source, link) && bee::file_read(source) == big);
+    CHECK("Copy No Leftovers", std::distance(bee::fs::directory_iterator(dir), bee::fs::directory_iterator()) == 4);
+#ifdef __linux__
+    auto const status = (dir / "status.txt").string();
+    CHECK("Copy Procfs", bee::file_copy("/proc/self/status", status) && bee::file_read(status).starts_with("Name:"));
+#endif
+    bee::fs::remove_all(dir);
+});
+
+TEST("Binary Cursors", {
+    Vec<u8> buffer;
+    bee::BinWriter writer(buffer);
+    writer.write<u32>(0x01020304);
+    writer.write_be<u32>(0x01020304);
+    CHECK("Endianness", buffer == Vec<u8> { 4, 3, 2, 1, 1, 2, 3, 4 });
+
+    writer.write<i16>(-2);
+    writer.write_be<f64>(3.5);
+    writer.write<f32>(-0.25f);
+    for (u64 const value : { 0ull, 127ull, 128ull, 300ull, ~0ull }) {
+        writer.write_varint(value);
+    }
+    writer.write_varint_signed(-1);
+    writer.write_varint_signed(INT64_MIN);
+    writer.write_str("bee");
+    writer.align(alignof(f32));
+    Arr<f32, 3> const floats = { 1.f, 2.f, 3.f };
+    writer.write_span<f32>(floats);
+    CHECK("Writer Size", writer.ok() && writer.size() == buffer.size() && buffer.size() % alignof(f32) == 0);
+
+    Vec<u8> prefixed = { 0xAA };
+    bee::BinWriter appender(prefixed);
+    appender.align(8);
+    CHECK("Align From Buffer Start", prefixed.size() == 8 && appender.size() == 7);
+
+    bee::BinReader reader(buffer); // Vec storage is aligned enough for the f32 span
+    CHECK("Read LE", reader.read<u32>() == 0x01020304 && reader.read_be<u32>() == 0x01020304);
+    CHECK("Read Scalars", reader.read<i16>() == -2 && reader.read_be<f64>() == 3.5 && reader.read<f32>() == -0.25f);
+    b8 varints_ok = true;
+    for (u64 const value : { 0ull, 127ull, 128ull, 300ull, ~0ull }) {
+        varints_ok &= reader.read_varint() == value;
+    }
+    CHECK("Varints", varints_ok && reader.read_varint_signed() == -1 && reader.read_varint_signed() == INT64_MIN);
+    auto const text = reader.read_str();
+    CHECK("String View", text == "bee" && recast(u8 const *, text.data()) > buffer.data());
+    reader.align(alignof(f32));
+    auto const span = reader.read_span<f32>(3);
+    CHECK("Span Zero Copy", span.size() == 3 && span[2] == 3.f && recast(u8 const *, span.data()) >= buffer.data());
+    CHECK("At End", reader.ok() && reader.at_end() && reader.remaining() == 0);
+
+#if BEE_BIN_CHECKS
+    CHECK("Past End", reader.read<u64>() == 0 && !reader.ok() && reader.read_str(1).empty());
+    bee::BinReader truncated(SpanConst<u8>(buffer.data(), 6));
+    CHECK("Truncated", truncated.read<u32>() == 0x01020304 && truncated.read<u32>() == 0 && !truncated.ok());
+    Arr<u8, 11> const endless { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    bee::BinReader overlong(endless);
+    CHECK("Overlong Varint", overlong.read_varint() == 0 && !overlong.ok());
+    Arr<u8, 10> top { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    bee::BinReader top_bit(top);
+    CHECK("Top Bit Varint", top_bit.read_varint() == 1ull << 63 && top_bit.ok());
+    top[9] = 0x02;
+    bee::BinReader past_top(top);
+    CHECK("Past Top Varint", past_top.read_varint() == 0 && !past_top.ok());
+    bee::BinReader misaligned(SpanConst<u8>(buffer.data() + 1, 8));
+    CHECK("Misaligned Span", misaligned.read_span<u32>(1).empty() && !misaligned.ok());
+#endif
+
+    auto const path = (bee::fs::temp_directory_path() / "bee_tests_cursor.bin").string();
+    {
+        bee::FileWriter file(path, bee::WriteMode::Trunc);
+        bee::BinWriter to_file(file);
+        to_file.write_str("header");
+        to_file.write_be<u16>(513);
+        CHECK("File Writer", to_file.ok() && to_file.size() == 9);
+    }
+    {
+        bee::FileWriter file(path, bee::WriteMode::Append);
+        bee::BinWriter to_file(file);
+        to_file.align(4);
+        CHECK("Align From File Start", file.position() == 12 && to_file.size() == 3);
+    }
+    auto const mapped = bee::bin_view(path);
+    bee::BinReader from_file(mapped);
+    CHECK("From File", from_file.read_str() == "header" && from_file.read_be<u16>() == 513 && from_file.align(4) &&
+                               from_file.at_end());
+    bee::fs::remove(path);
+});
+
+TEST("Mapped Files", {
+    auto const text = bee::file_view("./to_file_read.txt");
+    CHECK("Open", text.is_open() && text.view() == "Test\nfile\nfor\nDISCO\n");
+    Vec<u8> const magic { 'T', 'e', 's', 't' };
+    CHECK("Magic Zero Copy", bee::bin_check_magic(bee::bin_view("./to_file_read.txt"), magic));
+
+    bee::MappedFile moved = bee::bin_view("./to_file_read.txt", bee::MapHint::Random | bee::MapHint::WillNeed);
+    bee::MappedFile target = std::move(moved);
+    CHECK("Move", !moved.is_open() && target.size() == 20 && target.bytes()[0] == 'T');
+    target.close();
+    CHECK("Close", !target && target.empty() && target.data() == nullptr);
+
+    CHECK("Missing", !bee::file_view("./this_file_does_not_exist.txt").is_open());
+    auto const empty_path = (bee::fs::temp_directory_path() / "bee_tests_empty.bin").string();
+    std::ofstream { empty_path };
+    auto const empty = bee::bin_view(empty_path);
+    CHECK("Empty", empty.is_open() && empty.empty() && empty.view().empty());
+    bee::fs::remove(empty_path);
+});
+
+TEST("Record Reader", {
+    auto const path = (bee::fs::temp_directory_path() / "bee_tests_records.txt").string();
+    Str const long_line(100, 'L');
+    (void)bee::file_write_trunc(path, "first\r\nsecond\n\n" + long_line + "\nno newline at end");
+
+    Vec<Str> lines;
+    bee::LineReader reader(path, 8); // Tiny chunks so most lines cross a boundary
+    reader.for_each([&](std::string_view line) { lines.emplace_back(line); });
+    CHECK("Lines", lines == Vec<Str> { "first", "second", "", long_line, "no newline at end" });
+    CHECK("Counters", reader.records() == 5 && reader.bytes_read() == bee::fs::file_size(path) && !reader.failed());
+    std::string_view line;
+    CHECK("Stays At End", !reader.next(line));
+
+    (void)bee::file_write_trunc(path, "a,bb,ccc,");
+    Vec<Str> records;
+    bee::RecordReader commas(path, ',', 4);
+    commas.for_each([&](std::string_view record) { records.emplace_back(record); });
+    CHECK("Delimiter", records == Vec<Str> { "a", "bb", "ccc" });
+
+    bee::RecordReader missing("./this_file_does_not_exist.txt");
+    CHECK("Missing", !missing.is_open() && !missing.next(line));
+    bee::fs::remove(path);
+});
+
+TEST("Directory Utils", {
+    auto const root = bee::fs::temp_directory_path() / "bee_tests_dir_scan";
+    bee::fs::remove_all(root);
+    bee::fs::create_directories(root / "sub" / "deeper");
+    for (auto const *name : { "a.txt", "B.TXT", "c.bin", ".hidden.txt", "sub/d.txt", "sub/deeper/e.txt" }) {
+        (void)bee::file_write_trunc((root / name).string(), Str(name));
+    }
+    auto const names = [&](Vec<Str> const &paths) {
+        Vec<Str> out;
+        for (Str const &path : paths) {
+            out.push_back(bee::fs::relative(path, root).generic_string());
+        }
+        return out;
+    };
+
+    CHECK("All", bee::dir_scan(root.string()).size() == 6);
+    auto const txt = bee::dir_scan(root.string(), { .extensions = { "txt" } });
+    CHECK("Extension", names(txt) == Vec<Str> { ".hidden.txt", "B.TXT", "a.txt", "sub/d.txt", "sub/deeper/e.txt" });
+    CHECK("Dotted Extension", bee::dir_scan(root.string(), { .extensions = { ".bin" } }).size() == 1);
+    CHECK("Flat", bee::dir_scan(root.string(), { .extensions = {}, .recursive = false }).size() == 4);
+    CHECK("No Hidden", bee::dir_scan(root.string(), { .extensions = {}, .include_hidden = false }).size() == 5);
+    CHECK("Missing", bee::dir_scan((root / "nope").string()).empty());
+    bee::fs::create_symlink(root / "a.txt", root / "link.txt");
+    CHECK("Skip File Links", bee::dir_scan(root.string()).size() == 6);
+    CHECK("Follow File Links", bee::dir_scan(root.string(), { .extensions = {}, .follow_symlinks = true }).size() == 7);
+    bee::ThreadPool pool(2);
+    pool.spawn([] { throw std::runtime_error("unrelated"); });
+    CHECK("Unrelated Error", bee::dir_scan(root.string(), {}, pool).size() == 6);
+
+    Vec<Str> contents;
+    CHECK("Load", bee::files_load(txt, contents) && contents[1] == "B.TXT" && contents[4] == "sub/deeper/e.txt");
+    bee::ScratchArena arena;
+    Vec<std::string_view> views;
+    CHECK("Load Arena", bee::files_load(txt, arena, views) && views[0] == ".hidden.txt" && views[3] == "sub/d.txt");
+    Arr<Str, 1> const missing = { (root / "nope.txt").string() };
+    CHECK("Load Missing", !bee::files_load(missing, contents) && contents[0].empty());
+#ifdef __linux__
+    Arr<Str, 1> const procfs = { "/proc/self/status" }; // Reports a size of 0
+    CHECK("Load Arena Procfs", bee::files_load(procfs, arena, views) && views[0].starts_with("Name:"));
+#endif
+    bee::fs::remove_all(root);
+});
+
+TEST("File Cache", {
+    auto const dir = bee::fs::temp_directory_path();
+    auto const path = (dir / "bee_tests_cache.txt").string();
+    for (b8 const watch : { false, true }) {
+        (void)bee::file_write_trunc(path, "one");
+        bee::FileCache cache({ .budget_bytes = 1 << 20, .watch = watch });
+        auto const first = cache.get(path);
+        CHECK("Load", first && first->view() == "one");
+        CHECK("Hit Shares Buffer", cache.get(path) == first);
+
+        (void)bee::file_write_trunc(path, "three"); // New size, so coarse mtimes can't hide it
+        CHECK("Snapshot", first->view() == "one");
+        for (i32 i = 0; cache.watching() && cache.stats().invalidations == 0 && i < 2000; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        auto const second = cache.get(path);
+        CHECK("Reload", second && second != first && second->view() == "three");
+        auto const stats = cache.stats();
+        CHECK("Stats", stats.hits == 1 && stats.misses == (watch ? 2 : 1) && stats.stale == (watch ? 0 : 1));
+        CHECK("Watcher", !watch || (cache.watching() && stats.invalidations == 1));
+        CHECK("Hit Rate", cache.get(path) == second && bee::fuzzy_eq(as(f32, cache.hit_rate()), 0.5f));
+
+        CHECK("Invalidate", cache.invalidate(path) && cache.size() == 0 && !cache.invalidate(path));
+        (void)cache.get(path);
+        cache.clear();
+        CHECK("Clear", cache.size() == 0 && cache.get(path) && cache.size() == 1);
+        CHECK("Clear Not Invalidation", cache.stats().invalidations == (watch ? 1 : 0));
+        CHECK("Missing", !cache.get((dir / "bee_tests_cache_missing.txt").string()));
+    }
+
+    bee::FileCache small({ .budget_bytes = 2500 });
+    Vec<Str> paths;
+    for (i32 i = 0; i < 3; ++i) {
+        paths.push_back((dir / ("bee_tests_cache_" + std::to_string(i) + ".bin")).string());
+        (void)bee::file_write_trunc(paths.back(), Str(1000, 'a' + i));
+        (void)small.get(paths.back());
+    }
+    CHECK("Budget", small.size() == 2 && small.bytes() <= small.budget() && small.stats().evictions == 1);
+    CHECK("Evicts Oldest", small.get(paths[2]) && small.stats().hits == 1 && small.get(paths[0]));
+    CHECK("Evicted Was Miss", small.stats().misses == 4);
+
+    for (Str const &file : paths) {
+        bee::fs::remove(file);
+    }
+    bee::fs::remove(path);
+});
+
+#ifdef __linux__
+TEST("File Watcher", {
+    auto const dir = bee::fs::temp_directory_path() / "bee_tests_watcher";
+    bee::fs::remove_all(dir);
+    bee::fs::create_directories(dir);
+    auto const file = (dir / "config.txt").string();
+    auto const wait_for = [](auto &&done) {
+        for (i32 i = 0; !done() && i < 2000; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    };
+
+    std::mutex mtx;
+    Vec<bee::FileChange> dir_changes;
+    Vec<bee::FileChange> file_changes;
+    {
+        bee::FileWatcher watcher(250); // Long enough for the whole burst to land in one window
+        CHECK("Running", watcher.is_running());
+        auto const dir_id = watcher.watch(dir.string(), [&](bee::FileChange const &change) {
+            bee_lock(mtx);
+            dir_changes.push_back(change);
+        });
+        auto const file_id = watcher.watch(file, [&](bee::FileChange const &change) {
+            bee_lock(mtx);
+            file_changes.push_back(change);
+        });
+        CHECK("Ids", dir_id != 0 && file_id != 0 && dir_id != file_id);
+
+        for (i32 i = 0; i < 5; ++i) { // A save burst
+            (void)bee::file_write_append(file, "line\n");
+        }
+        auto const file_seen = [&] {
+            bee_lock(mtx);
+            return !file_changes.empty();
+        };
+        CHECK("Burst Seen", wait_for(file_seen));
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        {
+            bee_lock(mtx);
+            CHECK("Coalesced", file_changes.size() == 1 && dir_changes.size() == 1);
+            CHECK("Events", file_changes[0].path == file && file_changes[0].events & bee::FileEvent::Created &&
+                                file_changes[0].events & bee::FileEvent::Modified);
+            file_changes.clear();
+            dir_changes.clear();
+        }
+
+        (void)bee::file_write_trunc((dir / "other.txt").string(), "x");
+        auto const other_seen = [&] {
+            bee_lock(mtx);
+            return !dir_changes.empty();
+        };
+        CHECK("Directory Only", wait_for(other_seen) && file_changes.empty());
+
+        (void)bee::file_write_trunc((dir / "config.tmp").string(), "saved");
+        bee::fs::rename(dir / "config.tmp", file); // Atomic save
+        CHECK("Replaced", wait_for(file_seen));
+
+        auto const sub = dir / "sub";
+        bee::fs::create_directories(sub);
+        std::atomic<b8> sub_removed = false;
+        (void)watcher.watch(sub.string(), [&](bee::FileChange const &change) {
+            sub_removed = sub_removed || (change.path == sub.string() && change.events & bee::FileEvent::Removed);
+        });
+        (void)watcher.watch((sub / "").string(), {}); // Same directory spelled with a trailing separator
+        bee::fs::remove(sub);
+        CHECK("Directory Removed", wait_for([&] { return sub_removed.load(); }));
+
+        CHECK("Unwatch", watcher.unwatch(file_id) && !watcher.unwatch(file_id));
+        {
+            bee_lock(mtx);
+            file_changes.clear();
+        }
+        bee::fs::remove(file);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        (void)bee::file_write_trunc(file, "late"); // After this scope nothing may fire
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+        bee_lock(mtx);
+        CHECK("Unwatched Quiet", file_changes.empty());
+    }
+    CHECK("Missing Dir", bee::FileWatcher().watch((dir / "nope" / "x.txt").string(), {}) == 0);
+    bee::fs::remove_all(dir);
+});
+#endif
+
+#ifdef BEE_HAS_POSIX_IO
+TEST("IoRing", {
+    auto const path = (bee::fs::temp_directory_path() / "bee_tests_ioring.bin").string();
+    for (b8 const allow_uring : { true, false }) {
+        bee::IoRing ring(8, bee::thread_pool(), allow_uring);
+        CHECK("Backend", allow_uring || !ring.uses_uring());
+        i32 const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        Str const text = "io ring says hi";
+        i64 written = -1, synced = -1;
+        ring.write(fd, SpanConst<u8>(recast(u8 const *, text.data()), text.size()), 0, [&](i64 r) { written = r; });
+        ring.link();
+        ring.fsync(fd, [&](i64 r) { synced = r; });
+        CHECK("Queued", ring.in_flight() == 2 && written == -1);
+        ring.drain();
+        CHECK("Write Link Fsync", written == as(i64, text.size()) && synced == 0 && ring.in_flight() == 0);
+
+        Arr<u8, 6> bytes {};
+        i64 read = -1;
+        ring.read(fd, bytes, 3, [&](i64 r) { read = r; });
+        ring.wait();
+        CHECK("Read", read == 6 && Str(bytes.begin(), bytes.end()) == "ring s");
+
+        Arr<u8, 16> pinned {};
+        Arr<Span<u8>, 1> const buffers = { pinned };
+        CHECK("Register", ring.register_buffers(buffers));
+        ring.read_fixed(fd, 0, Span<u8>(pinned).first(2), 0, [&](i64 r) { read = r; });
+        ring.drain();
+        CHECK("Read Fixed", read == 2 && pinned[0] == 'i' && pinned[1] == 'o');
+
+        i64 failed = 0, cancelled = 0;
+        ring.read(-1, bytes, 0, [&](i64 r) { failed = r; });
+        ring.link();
+        ring.read(fd, bytes, 0, [&](i64 r) { cancelled = r; });
+        ring.drain();
+        CHECK("Link Cancels", failed == -EBADF && cancelled == -ECANCELED);
+
+        // A submit between the two ops sends the first alone, the link still holds
+        failed = cancelled = 0;
+        ring.read(-1, bytes, 0, [&](i64 r) { failed = r; });
+        ring.link();
+        ring.submit();
+        ring.read(fd, bytes, 0, [&](i64 r) { cancelled = r; });
+        ring.drain();
+        CHECK("Link Cut Cancels", failed == -EBADF && cancelled == -ECANCELED);
+        written = synced = -1;
+        ring.write(fd, SpanConst<u8>(recast(u8 const *, text.data()), text.size()), 0, [&](i64 r) { written = r; });
+        ring.link();
+        ring.submit();
+        ring.fsync(fd, [&](i64 r) { synced = written >= 0 ? r : -1; });
+        ring.drain();
+        CHECK("Link Cut Runs", written == as(i64, text.size()) && synced == 0);
+
+        // Every push cuts the chain of a one entry ring, the cancel still runs to its end
+        bee::IoRing tiny(1, bee::thread_pool(), allow_uring);
+        Arr<i64, 4> results {};
+        tiny.read(-1, bytes, 0, [&](i64 r) { results[0] = r; });
+        tiny.link();
+        tiny.read(fd, bytes, 0, [&](i64 r) { results[1] = r; });
+        tiny.link();
+        tiny.read(fd, bytes, 0, [&](i64 r) { results[2] = r; });
+        tiny.read(fd, bytes, 0, [&](i64 r) { results[3] = r; });
+        tiny.drain();
+        CHECK("Link Cut Chain", results == Arr<i64, 4> { -EBADF, -ECANCELED, -ECANCELED, 6 });
+
+        // Waiting from the only worker of the pool the fallback runs on
+        bee::ThreadPool single(1);
+        auto nested = single.submit([&] {
+            bee::IoRing inner(4, single, allow_uring);
+            i64 result = -1;
+            inner.read(fd, bytes, 0, [&](i64 r) { result = r; });
+            inner.drain();
+            return result;
+        });
+        CHECK("Wait In Pool", single.wait(nested) == 6);
+
+        Arr<Str, 3> const paths = { path, "./to_file_read.txt", "./this_file_does_not_exist.txt" };
+        auto const contents = bee::file_read_many(paths, ring);
+        CHECK("Read Many", contents[0] == text && contents[1] == "Test\nfile\nfor\nDISCO\n" && contents[2].empty());
+        ::close(fd);
+    }
+    bee::fs::remove(path);
+});
+#endif
+
+
+// ==============================================
+// ========== Scratch allocator
+
+TEST("Scratch Allocator", {
+    auto &arena = bee::scratch();
+    usize const used_before = arena.used();
+    {
+        bee_scratch_scope();
+        bee::ScratchVec<i32> v;
+        v.reserve(256);
+        for (i32 i = 0; i < 256; ++i) {
+            v.push_back(i);
+        }
+        bee::ScratchStr s = "a scratch string long enough to skip the small string buffer";
+        CHECK("Alloc", arena.used() > used_before);
+        CHECK("Values", v[255] == 255 && s.back() == 'r');
+        CHECK("Alignment", recast(uintptr_t, arena.alloc(64, 64)) % 64 == 0);
+        CHECK("Big Alloc", arena.alloc(4 << 20) != nullptr);
+    }
+    CHECK("Rewind", arena.used() == used_before);
+
+    bee::ScratchArena *other = nullptr;
+    std::thread([&] { other = &bee::scratch(); }).join();
+    CHECK("Thread Local", other != &arena);
+});
+
+
+// ==============================================
+// ========== Slot map
+
+TEST("Slot Map", {
+    bee::SlotMap<Str> map;
+    auto const a = map.insert("a");
+    auto const b = map.insert("b");
+    auto const c = map.emplace(1, 'c');
+    CHECK("Null", !map.contains(bee::slot_null) && map.get(bee::slot_null) == nullptr);
+    CHECK("Insert", map.size() == 3 && *map.get(a) == "a" && *map.get(b) == "b" && *map.get(c) == "c");
+
+    CHECK("Erase", map.erase(a) && map.size() == 2);
+    CHECK("Erase Stale", !map.erase(a));
+    CHECK("Stale", !map.contains(a) && map.get(a) == nullptr);
+    CHECK("Moved", *map.get(b) == "b" && *map.get(c) == "c");
+
+    auto const d = map.insert("d");
+    CHECK("Reuse Slot", (d & 0xFFFFFFFF) == (a & 0xFFFFFFFF) && d != a);
+    CHECK("Reuse Stale", map.get(a) == nullptr && *map.get(d) == "d");
+
+    map.erase(d);
+    b8 threw = false;
+    try {
+        map.emplace(Str().max_size() + 1, 'x');
+    } catch (std::length_error const &) {
+        threw = true;
+    }
+    auto const e = map.insert("e");
+    CHECK("Ctor Throws", threw && map.size() == 3 && (e & 0xFFFFFFFF) == (d & 0xFFFFFFFF) && *map.get(e) == "e");
+    CHECK("Ctor Throws Stale", map.get(d) == nullptr && map.values().size() == 3);
+
+    Str joined;
+    for (auto const &value : map) {
+        joined += value;
+    }
+    CHECK("Dense", joined.size() == 3 && map.values().size() == 3);
+    CHECK("Handle Of", map.handle_of(0) == c || map.handle_of(0) == b || map.handle_of(0) == e);
+
+    map.clear();
+    CHECK("Clear", map.empty() && !map.contains(b) && !map.contains(c) && !map.contains(e));
+});
+
+
+// ==============================================
+// ========== Struct of arrays
+
+TEST("Struct of Arrays", {
+    bee::SoA<f32, i32, Str> soa;
+    soa.push_back(1.f, 10, "a");
+    soa.push_back(2.f, 20, "b");
+    soa.push_back(3.f, 30, "c");
+    CHECK("Size", soa.size() == 3);
+
+    auto [f, i, str] = soa[1];
+    CHECK("Row", f == 2.f && i == 20 && str == "b");
+    i = 21;
+    CHECK("Row Proxy", std::get<1>(soa[1]) == 21);
+
+    CHECK("Field", soa.field<0>().size() == 3 && soa.field<1>()[2] == 30);
+    CHECK("Aligned", recast(uintptr_t, soa.field<0>().data()) % 64 == 0);
+
+    i32 sum = 0;
+    for (auto [f, i, str] : soa) {
+        sum += i;
+    }
+    CHECK("Iterate", sum == 61);
+
+    soa.swap_remove(0);
+    CHECK("Swap Remove", soa.size() == 2 && std::get<2>(soa[0]) == "c");
+
+    Vec<f32> const values { 0.f, 50.f, 100.f };
+    Vec<f32> mapped(3);
+    bee::map(values, mapped, 0.f, 100.f, -1.f, 1.f);
+    CHECK("Batched Map", bee::fuzzy_eq(mapped, Vec<f32> { -1.f, 0.f, 1.f }));
+    CHECK("Batched Fuzzy Eq", !bee::fuzzy_eq(mapped, Vec<f32> { -1.f, 0.f, 2.f }));
+});
+
+
+// ==============================================
+// ========== Thread pool
+
+TEST("Thread Pool", {
+    bee::ThreadPool pool(4);
+    CHECK("Size", pool.size() == 4);
+
+    auto future = pool.submit([] { return 42; });
+    CHECK("Submit", pool.wait(future) == 42);
+
+    std::atomic<i64> sum = 0;
+    pool.parallel_for(0, 10'000, [&](usize i) { sum += as(i64, i); });
+    CHECK("Parallel For", sum == 49'995'000);
+
+    std::atomic<i64> nested = 0;
+    pool.parallel_for(0, 16, [&](usize) { pool.parallel_for(0, 100, [&](usize) { nested++; }, 10); }, 1);
+    CHECK("Nested", nested == 1600);
+
+    auto outer = pool.submit([&] {
+        auto inner = pool.submit([] { return 7; });
+        return pool.wait(inner) * 2;
+    });
+    CHECK("Nested Submit", pool.wait(outer) == 14);
+
+    Vec<i32> items(1000, 1);
+    bee::parallel_for_each(items, [](i32 &item) { item *= 3; });
+    CHECK("Parallel For Each", std::all_of(items.begin(), items.end(), [](i32 i) { return i == 3; }));
+
+    std::atomic<i32> spawned = 0;
+    for (i32 i = 0; i < 100; ++i) {
+        pool.spawn([&] { spawned++; });
+    }
+    pool.wait_until([&] { return spawned == 100; });
+    CHECK("Spawn", spawned == 100);
+
+    auto const throws_at = [&](usize at) {
+        std::atomic<i32> ran = 0;
+        b8 threw = false;
+        try {
+            pool.parallel_for(0, 64, [&](usize i) {
+                ran++;
+                if (i == at) {
+                    throw std::runtime_error("chunk");
+                }
+            }, 1);
+        } catch (std::runtime_error const &) {
+            threw = true;
+        }
+        return threw && ran == 64;
+    };
+    CHECK("Parallel For Throws", throws_at(0) && throws_at(63));
+
+    pool.spawn([] { throw std::runtime_error("spawn"); });
+    auto unrelated = pool.submit([] { return 5; });
+    CHECK("Unrelated Wait", pool.wait(unrelated) == 5);
+    std::exception_ptr error;
+    pool.wait_until([&] { return (error = pool.take_error()) != nullptr; });
+    b8 spawn_threw = false;
+    try {
+        std::rethrow_exception(error);
+    } catch (std::runtime_error const &) {
+        spawn_threw = true;
+    }
+    CHECK("Spawn Throws", spawn_threw && !pool.take_error());
+});
+
+TEST("Task Graph", {
+    bee::ThreadPool pool(4);
+    bee::TaskGraph graph;
+
+    std::atomic<i32> clock = 0;
+    Arr<i32, 4> stamps {};
+    auto const parse = graph.add("parse", [&] { stamps[0] = ++clock; });
+    auto const fast = graph.add("fast", [&] { stamps[1] = ++clock; });
+    auto const slow = graph.add("slow", [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stamps[2] = ++clock;
+    });
+    auto const write = graph.add("write", [&] { stamps[3] = ++clock; });
+    graph.precede(parse, fast);
+    graph.precede(parse, slow);
+    graph.precede(fast, write);
+    graph.precede(slow, write);
+
+    b8 ordered = true;
+    for (i32 run = 0; run < 10; ++run) {
+        clock = 0;
+        CHECK("Run", graph.run(pool));
+        ordered &= stamps[0] == 1 && stamps[3] == 4 && stamps[1] > 1 && stamps[2] > 1;
+    }
+    CHECK("Order", ordered);
+    CHECK("Timing", graph.elapsed_ms(slow) >= 4. && graph.elapsed_ms() >= graph.elapsed_ms(slow));
+    CHECK("Critical Path", graph.critical_path() == Vec<bee::TaskGraph::NodeId> { parse, slow, write });
+    CHECK("Name", graph.name(slow) == "slow");
+
+    graph.precede(write, parse);
+    CHECK("Cycle", !graph.run(pool));
+
+    bee::TaskGraph failing;
+    b8 fail = true;
+    std::atomic<i32> after = 0;
+    auto const source = failing.add("source", [] {});
+    auto const thrower = failing.add("thrower", [&] {
+        if (fail) {
+            throw std::runtime_error("node");
+        }
+    });
+    for (i32 i = 0; i < 8; ++i) {
+        auto const sibling = failing.add("sibling", [] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+        failing.precede(source, sibling);
+    }
+    failing.precede(thrower, failing.add("after", [&] { after++; }));
+    failing.precede(source, thrower);
+    b8 threw = false;
+    try {
+        failing.run(pool);
+    } catch (std::runtime_error const &) {
+        threw = true;
+    }
+    CHECK("Node Throws", threw && after == 0);
+    fail = false;
+    CHECK("Rerun", failing.run(pool) && after == 1);
+});
+
+TEST("Parallel Algorithms", {
+    bee::ThreadPool pool(4);
+    usize const count = 200'000;
+
+    Vec<u32> values(count);
+    u32 seed = 12345;
+    for (auto &value : values) {
+        seed = seed * 1664525u + 1013904223u;
+        value = seed >> 8;
+    }
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    auto par_sorted = values;
+    bee::par::sort(par_sorted, std::less<> {}, pool);
+    CHECK("Sort", par_sorted == sorted);
+    bee::par::sort(par_sorted, std::greater<> {}, pool);
+    CHECK("Sort Cmp", std::is_sorted(par_sorted.rbegin(), par_sorted.rend()));
+
+    Vec<u64> doubled(count);
+    bee::par::transform(values, doubled, [](u32 v) { return as(u64, v) * 2; }, pool);
+    CHECK("Transform", doubled[777] == as(u64, values[777]) * 2 && doubled.back() == as(u64, values.back()) * 2);
+
+    u64 const sum = std::accumulate(values.begin(), values.end(), u64(0));
+    CHECK("Reduce", bee::par::reduce(values, u64(0), std::plus<> {}, pool) == sum);
+
+    Vec<f32> floats(count);
+    for (usize i = 0; i < count; ++i) {
+        floats[i] = 1.f / as(f32, i + 1);
+    }
+    bee::ThreadPool single(1);
+    f32 const reduced = bee::par::reduce(floats, 0.f, std::plus<> {}, pool);
+    CHECK("Reduce Deterministic", reduced == bee::par::reduce(floats, 0.f, std::plus<> {}, single));
+
+    Vec<u64> scanned(count);
+    Vec<u64> expected(count);
+    std::inclusive_scan(doubled.begin(), doubled.end(), expected.begin());
+    bee::par::inclusive_scan(doubled, scanned, std::plus<> {}, pool);
+    CHECK("Inclusive Scan", scanned == expected);
+
+    bee::par::for_each(Span<u64>(scanned), [](u64 &v) { v = 1; }, pool);
+    CHECK("For Each", bee::par::reduce(scanned, u64(0), std::plus<> {}, pool) == count);
+});
+
+
+// ==============================================
+// ========== Coroutines
+
+#ifdef BEE_HAS_COROUTINES
+bee::Task<u64> coro_depth(u64 n) {
+    if (n == 0) {
+        co_return 0;
+    }
+    co_return 1 + co_await coro_depth(n - 1);
+}
+
+bee::Task<Str> coro_roundtrip(Str path, Str content, bee::ThreadPool &pool) {
+    co_await bee::file_write_trunc_async(path, content, pool);
+    co_await bee::file_write_append_async(path, "+", pool);
+    auto const bin = co_await bee::bin_read_async(path, pool);
+    co_return (co_await bee::file_read_async(path, pool)) + Str(bin.size() > 0 ? "" : "!");
+}
+
+TEST("Coroutines", {
+    CHECK("Symmetric Transfer", bee::sync_wait(coro_depth(1000)) == 1000);
+
+    bee::ThreadPool pool(4);
+    auto const on_pool = [](bee::ThreadPool &pool) -> bee::Task<std::thread::id> {
+        co_await bee::resume_on(pool);
+        co_return std::this_thread::get_id();
+    };
+    CHECK("Resume On", bee::sync_wait(on_pool(pool)) != std::this_thread::get_id());
+
+    auto const dir = bee::fs::temp_directory_path() / "bee_tests_coroutines";
+    bee::fs::create_directories(dir);
+    Vec<bee::Task<Str>> tasks;
+    for (i32 i = 0; i < 200; ++i) {
+        tasks.push_back(coro_roundtrip((dir / std::to_string(i)).string(), std::to_string(i), pool));
+    }
+    auto const contents = bee::sync_wait_all(std::move(tasks));
+    b8 all_ok = contents.size() == 200;
+    for (usize i = 0; i < contents.size(); ++i) {
+        all_ok &= contents[i] == std::to_string(i) + "+";
+    }
+    CHECK("File Roundtrip", all_ok);
+    bee::fs::remove_all(dir);
+
+    auto const fails = [](bee::ThreadPool &pool, b8 fail) -> bee::Task<i32> {
+        co_await bee::resume_on(pool);
+        if (fail) {
+            throw std::runtime_error("task");
+        }
+        co_return 1;
+    };
+    auto const threw = [](auto &&fn) {
+        try {
+            fn();
+        } catch (std::runtime_error const &) {
+            return true;
+        }
+        return false;
+    };
+    CHECK("Sync Wait Throws", threw([&] { (void)bee::sync_wait(fails(pool, true)); }));
+    CHECK("Sync Wait All Throws", threw([&] {
+        Vec<bee::Task<i32>> batch;
+        batch.push_back(fails(pool, false));
+        batch.push_back(fails(pool, true));
+        (void)bee::sync_wait_all(std::move(batch));
+    }));
+    auto const offload_fails = [](bee::ThreadPool &pool) -> bee::Task<i32> {
+        co_return co_await bee::offload([]() -> i32 { throw std::runtime_error("offload"); }, pool);
+    };
+    CHECK("Offload Throws", threw([&] { (void)bee::sync_wait(offload_fails(pool)); }));
+});
+#endif
+
+
+// ==============================================
+// ========== Lock-free queues
+
+TEST("Lock-free Queues", {
+    bee::SpscQueue<Str> spsc(3);
+    CHECK("Spsc Capacity", spsc.capacity() == 4);
+    CHECK("Spsc Push", spsc.try_push("a") && spsc.try_push("b") && spsc.try_push("c") && spsc.try_push("d"));
+    CHECK("Spsc Full", !spsc.try_push("e"));
+    Str out;
+    CHECK("Spsc Pop", spsc.try_pop(out) && out == "a" && spsc.size_approx() == 3);
+    Arr<Str, 8> batch;
+    CHECK("Spsc Pop Batch", spsc.try_pop_batch(batch) == 3 && batch[2] == "d");
+    CHECK("Spsc Empty", !spsc.try_pop(out));
+    CHECK("Spsc Push Batch", spsc.try_push_batch(batch) == 4 && spsc.pop() == "b");
+
+    bee::SpscQueue<u64> ints(64);
+    u64 received = 0;
+    std::thread consumer([&] {
+        for (u64 i = 0; i < 100'000; ++i) {
+            received += ints.pop() == i;
+        }
+    });
+    for (u64 i = 0; i < 100'000; ++i) {
+        ints.push(i);
+    }
+    consumer.join();
+    CHECK("Spsc Threads", received == 100'000);
+
+    bee::MpmcQueue<u64> mpmc(128);
+    std::atomic<u64> sum = 0;
+    Vec<std::thread> threads;
+    for (u64 p = 0; p < 4; ++p) {
+        threads.emplace_back([&, p] {
+            for (u64 i = 0; i < 10'000; ++i) {
+                mpmc.push(p * 10'000 + i);
+            }
+        });
+        threads.emplace_back([&] {
+            for (u64 i = 0; i < 10'000; ++i) {
+                sum += mpmc.pop();
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK("Mpmc Threads", sum == 40'000ull * 39'999ull / 2);
+    u64 none = 0;
+    CHECK("Mpmc Empty", !mpmc.try_pop(none));
+
+    bee::MpmcQueue<Str> leftovers(4);
+    CHECK("Mpmc Leftovers", leftovers.try_push(Str(100, 'x')) && leftovers.try_push(Str(100, 'y')));
+});
+
+
+// ==============================================
+// ========== Synchronization
+
+TEST("Synchronization", {
+    auto const hammer = [](auto &lock) {
+        i64 counter = 0;
+        Vec<std::thread> threads;
+        for (i32 t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                for (i32 i = 0; i < 10'000; ++i) {
+                    bee_lock(lock);
+                    ++counter;
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return counter;
+    };
+
+    bee::Spinlock spin;
+    CHECK("Spinlock Try", spin.try_lock() && !spin.try_lock());
+    spin.unlock();
+    CHECK("Spinlock Threads", hammer(spin) == 40'000);
+
+    bee::Mutex mtx;
+    CHECK("Mutex Try", mtx.try_lock() && !mtx.try_lock());
+    mtx.unlock();
+    CHECK("Mutex Threads", hammer(mtx) == 40'000);
+    {
+        std::lock_guard guard(mtx);
+        CHECK("Mutex Lockable", !mtx.try_lock());
+    }
+
+    struct Snapshot {
+        i64 a, b, c;
+    };
+    bee::SeqLock<Snapshot> seq({ 0, 0, 0 });
+    std::atomic<b8> done = false;
+    std::atomic<i32> torn = 0;
+    std::thread reader([&] {
+        while (!done) {
+            Snapshot const snap = seq.load();
+            torn += snap.b != snap.a * 2 || snap.c != snap.a * 3;
+        }
+    });
+    for (i64 i = 1; i <= 20'000; ++i) {
+        seq.store({ i, i * 2, i * 3 });
+    }
+    done = true;
+    reader.join();
+    CHECK("SeqLock Consistent", torn == 0);
+    CHECK("SeqLock Latest", seq.load().c == 60'000);
+
+    Arr<bee::Padded<std::atomic<i32>>, 2> padded;
+    padded[1]->store(3);
+    CHECK("Padded Layout", sizeof(padded[0]) == bee::cache_line_size && alignof(bee::Padded<i8>) == 64);
+    CHECK("Padded Access", padded[1]->load() == 3 && padded[0]->load() == 0 && *bee::Padded<i32>(7) == 7);
+});
+
+
+// ==============================================
+// ========== Snapshots
+
+struct Tracked {
+    inline static std::atomic<i32> alive = 0;
+    explicit Tracked(i64 v = 0) : a(v), b(v * 2) { ++alive; }
+    Tracked(Tracked const &other) : a(other.a), b(other.b) { ++alive; }
+    ~Tracked() { --alive; }
+    i64 a, b;
+};
+
+TEST("Snapshots", {
+    struct Frame {
+        i64 id;
+        Arr<i64, 32> values;
+    };
+    bee::TripleBuffer<Frame> triple;
+    CHECK("Triple Empty", !triple.update() && triple.read().id == 0);
+    triple.write_buffer().id = 1;
+    triple.publish();
+    triple.publish(Frame { 2, {} });
+    CHECK("Triple Latest", triple.update() && triple.read().id == 2 && !triple.update());
+
+    std::atomic<b8> done = false;
+    i32 torn = 0;
+    i64 last = 0;
+    std::thread reader([&] {
+        while (!done) {
+            Frame const &frame = triple.latest();
+            torn += frame.values[0] != frame.id || frame.values[31] != frame.id || frame.id < last;
+            last = frame.id;
+        }
+    });
+    for (i64 i = 3; i <= 20'000; ++i) {
+        Frame &frame = triple.write_buffer();
+        frame.id = i;
+        frame.values.fill(i);
+        triple.publish();
+    }
+    done = true;
+    reader.join();
+    CHECK("Triple Threads", torn == 0 && triple.latest().id == 20'000);
+
+    {
+        bee::LatestCell<Tracked, 4> cell(Tracked(1));
+        auto pinned = cell.read();
+        CHECK("Cell Read", pinned->a == 1);
+        for (i64 i = 2; i < 100; ++i) {
+            cell.emplace(i);
+        }
+        CHECK("Cell Pinned", pinned->a == 1 && pinned->b == 2 && cell.read()->a == 99);
+        CHECK("Cell Reclaim", cell.retired() < 16 && Tracked::alive < 20);
+
+        std::atomic<i32> bad = 0;
+        Vec<std::thread> readers;
+        for (i32 t = 0; t < 3; ++t) {
+            readers.emplace_back([&] {
+                for (i32 i = 0; i < 20'000; ++i) {
+                    auto const snapshot = cell.read();
+                    bad += snapshot->b != snapshot->a * 2;
+                }
+            });
+        }
+        for (i64 i = 100; i < 20'000; ++i) {
+            cell.emplace(i);
+        }
+        for (auto &thread : readers) {
+            thread.join();
+        }
+        CHECK("Cell Threads", bad == 0 && cell.read()->a == 19'999);
+    }
+    CHECK("Cell Freed", Tracked::alive == 0);
+});
+
+
+// ==============================================
+// ========== Hashing and LRU cache
+
+TEST("Hasher", {
+    bee::Hasher const hasher;
+    Str const owned = "the quick brown fox jumps over the lazy dog";
+    CHECK("Transparent", hasher(owned) == hasher(std::string_view(owned)) && hasher(owned) == hasher(owned.c_str()));
+    CHECK("Content", hasher(Str("abc")) != hasher(Str("abd")) && hasher(Str("")) != hasher(Str("a")));
+    CHECK("Seed", bee::hash_bytes("abc", 3, 1) != bee::hash_bytes("abc", 3, 2));
+    CHECK("Integers", hasher(1) != hasher(2) && hasher(u64(7)) == hasher(u64(7)));
+    CHECK("Mix", bee::details::hash_mix(u64_max, u64_max) == u64_max &&
+                     bee::details::hash_mix(0x9e3779b97f4a7c15ull, 0xa0761d6478bd642full) == 0x670527f286862c69ull);
+
+    Uset<usize> unique;
+    for (i32 i = 0; i < 10'000; ++i) {
+        unique.insert(hasher("key_" + std::to_string(i)) & 0xfffff);
+    }
+    CHECK("Spread", unique.size() > 9'900);
+});
+
+TEST("LRU Cache", {
+    bee::LruCache<Str, i32, bee::Hasher, 1> lru(3 * 100);
+    CHECK("Put", lru.put("a", 1, 100) && lru.put("b", 2, 100) && lru.put("c", 3, 100));
+    CHECK("Get View", lru.get(std::string_view("a")) == 1 && lru.get("b") == 2);
+    lru.put("d", 4, 100); // Evicts "c", "a" and "b" were used after it
+    CHECK("Evict LRU", !lru.contains("c") && lru.contains("a") && lru.size() == 3 && lru.bytes() == 300);
+    CHECK("Replace", lru.put("a", 10, 50) && lru.get("a") == 10 && lru.bytes() == 250);
+    CHECK("Too Big", !lru.put("huge", 0, 1000) && !lru.contains("huge"));
+    CHECK("Erase", lru.erase("a") && !lru.erase("a") && lru.bytes() == 200);
+
+    bee::CacheStats const stats = lru.stats();
+    CHECK("Stats", stats.hits == 3 && stats.misses == 0 && stats.inserts == 5 && stats.evictions == 1);
+
+    i32 calls = 0;
+    auto const make = [&] { return ++calls * 100; };
+    CHECK("Get Or", lru.get_or(std::string_view("x"), make) == 100 && lru.get_or("x", make) == 100 && calls == 1);
+    lru.clear();
+    CHECK("Clear", lru.size() == 0 && lru.bytes() == 0 && !lru.get("x"));
+    lru.put("k", 1, 100);
+    CHECK("Too Big Replace", !lru.put("k", 2, 1000) && !lru.get("k") && lru.size() == 0 && lru.bytes() == 0);
+
+    bee::LruCache<i32, Str> sharded(64 * 1024);
+    Vec<std::thread> threads;
+    std::atomic<i32> wrong = 0;
+    for (i32 t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (i32 i = 0; i < 5'000; ++i) {
+                i32 const key = (i * 31 + t) % 512;
+                if (auto const value = sharded.get(key)) {
+                    wrong += *value != std::to_string(key);
+                } else {
+                    sharded.put(key, std::to_string(key));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK("Threads", wrong == 0 && sharded.bytes() <= sharded.capacity() && sharded.stats().hits > 0);
+});
+
+inline i32 memo_square_calls = 0;
+inline i64 memo_square(i64 x) {
+    ++memo_square_calls;
+    return x * x;
+}
+
+// Only explicitly constructible and not default constructible, as key and as result
+struct MemoCelsius {
+    explicit MemoCelsius(f64 degrees) : degrees(degrees) {}
+    b8 operator==(MemoCelsius const &) const = default;
+    f64 degrees;
+};
+template <>
+struct std::hash<MemoCelsius> {
+    usize operator()(MemoCelsius const &celsius) const { return std::hash<f64> {}(celsius.degrees); }
+};
+
+TEST("Memoize", {
+    auto square = bee::memoize(&memo_square);
+    CHECK("Function Pointer", square(4) == 16 && square(4) == 16 && memo_square_calls == 1);
+    CHECK("Convertible Args", square(4u) == 16 && memo_square_calls == 1);
+    i32 halves = 0;
+    auto half = bee::memoize([&](f64 x) {
+        ++halves;
+        return x / 2.;
+    });
+    CHECK("Converted Key", half(3.) == 1.5 && half(3) == 1.5 && halves == 1 && half.stats().hits == 1);
+    auto fahrenheit = bee::memoize([](MemoCelsius celsius) { return MemoCelsius(celsius.degrees * 1.8 + 32.); });
+    CHECK("Explicit Key", fahrenheit(100.).degrees == 212. && fahrenheit(MemoCelsius(100.)).degrees == 212. &&
+                              fahrenheit.stats().hits == 1);
+
+    i32 calls = 0;
+    auto concat = bee::memoize([&](Str const &a, Str const &b) {
+        ++calls;
+        return a + b;
+    });
+    Str const left = "left";
+    CHECK("Heterogeneous", concat(left, "_right") == "left_right" &&
+                               concat(Str("left"), Str("_right")) == "left_right");
+    Str moved = "moved into the key, long enough to skip SSO";
+    CHECK("Move Args", concat(std::move(moved), "") == "moved into the key, long enough to skip SSO" && calls == 2);
+    CHECK("Moved From", moved.empty());
+    bee::CacheStats const stats = concat.stats();
+    CHECK("Stats", stats.hits == 1 && stats.misses == 2 && concat.size() == 2);
+
+    auto bounded = bee::memoize([&](i32 x) { return ++calls + x * 0; }, { .capacity = 2 });
+    i32 const first = bounded(1);
+    bounded(2);
+    bounded(3); // Evicts 1
+    CHECK("Capacity", bounded.size() == 2 && bounded(3) != first && bounded(1) != first &&
+                          bounded.stats().evictions == 2);
+
+    auto ttl = bee::memoize([&](i32) { return ++calls; }, { .ttl_ms = 20 });
+    i32 const fresh = ttl(0);
+    CHECK("TTL Hit", ttl(0) == fresh);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK("TTL Expired", ttl(0) != fresh && ttl.size() == 1);
+
+    std::atomic<i32> computed = 0;
+    auto shared = bee::memoize<true>([&](i32 x) {
+        ++computed;
+        return x * 2;
+    });
+    std::atomic<i32> wrong = 0;
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (i32 i = 0; i < 10'000; ++i) {
+                wrong += shared(i % 100) != (i % 100) * 2;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK("Thread Safe", wrong == 0 && shared.size() == 100 && computed >= 100 && shared.stats().hits >= 39'000);
 });
 
 
@@ -258,6 +1571,7 @@ TEST("File/Bin Helpers", {
 // ========== Constants
 
 inline int32_t BENCH_COUNT = 5;
+inline std::atomic<i64> BENCH_SINK = 0;
 
 
 // ==============================================
@@ -289,6 +1603,1112 @@ BENCH("Str Replace Many Sorted", BENCH_COUNT,
                                     Vec<Str> { "[1] ", "[2] ", "[3] ", "[4] " }));
 
 
+// ==============================================
+// ========== Scratch vs malloc temporaries
+
+inline constexpr i32 BENCH_THREADS = 16;
+
+template <typename VecT, typename StrT>
+void bench_temporaries() {
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < BENCH_THREADS; ++t) {
+        threads.emplace_back([] {
+            for (i32 i = 0; i < 1000; ++i) {
+                bee_scratch_scope();
+                VecT v;
+                for (i32 j = 0; j < 64; ++j) {
+                    v.push_back(j);
+                }
+                StrT s = "some temporary text that does not fit in sso";
+                s += s;
+                BENCH_SINK += v.back() + as(i64, s.size());
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+BENCH("Temporaries malloc (16 threads)", BENCH_COUNT, bench_temporaries<Vec<i32>, Str>());
+BENCH("Temporaries scratch (16 threads)", BENCH_COUNT, bench_temporaries<bee::ScratchVec<i32>, bee::ScratchStr>());
+
+
+// ==============================================
+// ========== Pooled vs heap allocation
+
+struct BenchObject {
+    i64 a = 0;
+    i64 b = 0;
+    f64 c = 0.;
+};
+inline constexpr i32 BENCH_OBJECTS = 100'000;
+
+BENCH("Alloc Unew", BENCH_COUNT, {
+    Vec<Uptr<BenchObject>> objects;
+    objects.reserve(BENCH_OBJECTS);
+    for (i32 i = 0; i < BENCH_OBJECTS; ++i) {
+        objects.push_back(Unew<BenchObject>(i, i, 0.));
+    }
+});
+BENCH("Alloc Pnew", BENCH_COUNT, {
+    Vec<Pptr<BenchObject>> objects;
+    objects.reserve(BENCH_OBJECTS);
+    for (i32 i = 0; i < BENCH_OBJECTS; ++i) {
+        objects.push_back(Pnew<BenchObject>(i, i, 0.));
+    }
+});
+BENCH("Alloc Snew", BENCH_COUNT, {
+    Vec<Sptr<BenchObject>> objects;
+    objects.reserve(BENCH_OBJECTS);
+    for (i32 i = 0; i < BENCH_OBJECTS; ++i) {
+        objects.push_back(Snew<BenchObject>(i, i, 0.));
+    }
+});
+BENCH("Alloc PSnew", BENCH_COUNT, {
+    Vec<Sptr<BenchObject>> objects;
+    objects.reserve(BENCH_OBJECTS);
+    for (i32 i = 0; i < BENCH_OBJECTS; ++i) {
+        objects.push_back(PSnew<BenchObject>(i, i, 0.));
+    }
+});
+
+
+// ==============================================
+// ========== Reference counted copies
+
+template <typename Ptr>
+void bench_copies(Ptr const &source) {
+    Vec<Ptr> copies(1000);
+    for (i32 i = 0; i < 100; ++i) {
+        for (auto &copy : copies) {
+            copy = source;
+        }
+        for (auto &copy : copies) {
+            copy = nullptr;
+        }
+    }
+}
+
+BENCH("Copies Sptr", BENCH_COUNT, bench_copies(Snew<BenchObject>()));
+BENCH("Copies Rc", BENCH_COUNT, bench_copies(Rnew<BenchObject>()));
+BENCH("Copies Arc", BENCH_COUNT, bench_copies(Anew<BenchObject>()));
+
+
+// ==============================================
+// ========== Slot map vs hash map of shared pointers
+
+inline constexpr u64 BENCH_POOL_SIZE = 100'000;
+
+BENCH("Pool Umap<u64, Sptr>", BENCH_COUNT, {
+    Umap<u64, Sptr<BenchObject>> pool;
+    for (u64 i = 0; i < BENCH_POOL_SIZE; ++i) {
+        pool[i] = Snew<BenchObject>(i, i, 0.);
+    }
+    for (u64 i = 0; i < BENCH_POOL_SIZE; i += 2) {
+        pool.erase(i);
+    }
+    for (u64 i = 1; i < BENCH_POOL_SIZE; i += 2) {
+        BENCH_SINK += pool[i]->a;
+    }
+    for (auto const &[id, object] : pool) {
+        BENCH_SINK += object->b;
+    }
+});
+BENCH("Pool SlotMap", BENCH_COUNT, {
+    bee::SlotMap<BenchObject> pool;
+    Vec<bee::SlotHandle> handles;
+    handles.reserve(BENCH_POOL_SIZE);
+    for (u64 i = 0; i < BENCH_POOL_SIZE; ++i) {
+        handles.push_back(pool.emplace(i, i, 0.));
+    }
+    for (u64 i = 0; i < BENCH_POOL_SIZE; i += 2) {
+        pool.erase(handles[i]);
+    }
+    for (u64 i = 1; i < BENCH_POOL_SIZE; i += 2) {
+        BENCH_SINK += pool.get(handles[i])->a;
+    }
+    for (auto const &object : pool) {
+        BENCH_SINK += object.b;
+    }
+});
+
+
+// ==============================================
+// ========== Particles, array of structs vs struct of arrays
+
+inline constexpr usize BENCH_PARTICLES = 1'000'000;
+
+BENCH("Particles AoS", BENCH_COUNT, {
+    struct Particle {
+        f32 x = 0.f, y = 0.f, z = 0.f;
+        f32 vx = 1.f, vy = 2.f, vz = 3.f;
+        Str name = "particle";
+    };
+    static Vec<Particle> particles(BENCH_PARTICLES);
+    for (auto &p : particles) {
+        p.x += p.vx * 0.016f;
+        p.y += p.vy * 0.016f;
+        p.z += p.vz * 0.016f;
+    }
+});
+BENCH("Particles SoA", BENCH_COUNT, {
+    static auto particles = [] {
+        bee::SoA<f32, f32, f32, f32, f32, f32, Str> soa;
+        soa.resize(BENCH_PARTICLES);
+        std::fill_n(soa.field<3>().data(), BENCH_PARTICLES, 1.f);
+        std::fill_n(soa.field<4>().data(), BENCH_PARTICLES, 2.f);
+        std::fill_n(soa.field<5>().data(), BENCH_PARTICLES, 3.f);
+        return soa;
+    }();
+    auto const x = particles.field<0>(), y = particles.field<1>(), z = particles.field<2>();
+    auto const vx = particles.field<3>(), vy = particles.field<4>(), vz = particles.field<5>();
+    for (usize i = 0; i < BENCH_PARTICLES; ++i) {
+        x[i] += vx[i] * 0.016f;
+        y[i] += vy[i] * 0.016f;
+        z[i] += vz[i] * 0.016f;
+    }
+});
+
+
+// ==============================================
+// ========== Parallel for
+
+inline constexpr usize BENCH_PARALLEL_ITEMS = 4'000'000;
+
+inline Vec<f32> &bench_parallel_data() {
+    static Vec<f32> data(BENCH_PARALLEL_ITEMS, 2.f);
+    return data;
+}
+
+BENCH("For Serial", BENCH_COUNT, {
+    auto &data = bench_parallel_data();
+    for (usize i = 0; i < data.size(); ++i) {
+        data[i] = std::sqrt(data[i] * data[i] + 1.f);
+    }
+});
+BENCH("For Parallel", BENCH_COUNT, {
+    auto &data = bench_parallel_data();
+    bee::parallel_for(0, data.size(), [&](usize i) { data[i] = std::sqrt(data[i] * data[i] + 1.f); });
+});
+
+
+// ==============================================
+// ========== Task graph vs async fan-out
+
+inline constexpr i32 BENCH_FANOUT = 32;
+
+inline void bench_stage(i32 seed) {
+    f64 acc = seed;
+    for (i32 i = 0; i < 2000; ++i) {
+        acc = std::sqrt(acc * acc + i);
+    }
+    BENCH_SINK += as(i64, acc);
+}
+
+BENCH("Pipeline std::async", BENCH_COUNT * 20, {
+    bench_stage(0);
+    Vec<std::future<void>> transforms;
+    for (i32 i = 0; i < BENCH_FANOUT; ++i) {
+        transforms.push_back(std::async(std::launch::async, bench_stage, i));
+    }
+    for (auto &transform : transforms) {
+        transform.get();
+    }
+    bench_stage(1);
+});
+BENCH("Pipeline TaskGraph", BENCH_COUNT * 20, {
+    static bee::TaskGraph graph;
+    if (graph.size() < 1) {
+        auto const parse = graph.add("parse", [] { bench_stage(0); });
+        auto const write = graph.add("write", [] { bench_stage(1); });
+        for (i32 i = 0; i < BENCH_FANOUT; ++i) {
+            auto const transform = graph.add("transform", [i] { bench_stage(i); });
+            graph.precede(parse, transform);
+            graph.precede(transform, write);
+        }
+    }
+    graph.run();
+});
+
+
+// ==============================================
+// ========== Parallel algorithms scaling
+
+inline constexpr usize BENCH_SORT_ITEMS = 1'000'000;
+
+inline Vec<u32> const &bench_sort_source() {
+    static Vec<u32> const source = [] {
+        Vec<u32> values(BENCH_SORT_ITEMS);
+        u32 seed = 1;
+        for (auto &value : values) {
+            seed = seed * 1664525u + 1013904223u;
+            value = seed;
+        }
+        return values;
+    }();
+    return source;
+}
+
+template <usize Threads>
+void bench_par_sort() {
+    static bee::ThreadPool pool(Threads);
+    auto values = bench_sort_source();
+    bee::par::sort(values, std::less<> {}, pool);
+    BENCH_SINK += bee::par::reduce(values, u64(0), std::plus<> {}, pool) & 1;
+}
+
+BENCH("Par Sort+Reduce serial", BENCH_COUNT, {
+    auto values = bench_sort_source();
+    std::sort(values.begin(), values.end());
+    BENCH_SINK += std::accumulate(values.begin(), values.end(), u64(0)) & 1;
+});
+BENCH("Par Sort+Reduce 1 thread", BENCH_COUNT, bench_par_sort<1>());
+BENCH("Par Sort+Reduce 2 threads", BENCH_COUNT, bench_par_sort<2>());
+BENCH("Par Sort+Reduce 4 threads", BENCH_COUNT, bench_par_sort<4>());
+BENCH("Par Sort+Reduce 8 threads", BENCH_COUNT, bench_par_sort<8>());
+BENCH("Par Sort+Reduce 16 threads", BENCH_COUNT, bench_par_sort<16>());
+
+
+// ==============================================
+// ========== Blocking vs awaitable file reads
+
+#ifdef BEE_HAS_COROUTINES
+inline constexpr i32 BENCH_FILES = 256;
+
+inline Vec<Str> const &bench_small_files() {
+    static Vec<Str> const paths = [] {
+        auto const dir = bee::fs::temp_directory_path() / "bee_bench_small_files";
+        bee::fs::create_directories(dir);
+        Vec<Str> files;
+        for (i32 i = 0; i < BENCH_FILES; ++i) {
+            files.push_back((dir / (std::to_string(i) + ".txt")).string());
+            (void)bee::file_write_trunc(files.back(), Str(4096, 'a' + (i % 26)));
+        }
+        return files;
+    }();
+    return paths;
+}
+
+BENCH("Read files blocking", BENCH_COUNT, {
+    for (auto const &path : bench_small_files()) {
+        BENCH_SINK += as(i64, bee::file_read(path).size());
+    }
+});
+BENCH("Read files awaitable", BENCH_COUNT, {
+    Vec<bee::Task<Str>> reads;
+    for (auto const &path : bench_small_files()) {
+        reads.push_back(bee::file_read_async(path));
+    }
+    for (auto const &content : bee::sync_wait_all(std::move(reads))) {
+        BENCH_SINK += as(i64, content.size());
+    }
+});
+#endif
+
+
+// ==============================================
+// ========== Queues throughput and latency
+
+template <typename T>
+class MutexQueue {
+public:
+    explicit MutexQueue(usize) {}
+
+    b8 try_push(T value) {
+        std::lock_guard lock(m_mtx);
+        m_items.push_back(value);
+        return true;
+    }
+    b8 try_pop(T &out) {
+        std::lock_guard lock(m_mtx);
+        if (m_items.empty()) {
+            return false;
+        }
+        out = m_items.front();
+        m_items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_mtx;
+    std::deque<T> m_items;
+};
+
+inline constexpr i64 BENCH_QUEUE_ITEMS = 64'000;
+
+template <typename Queue, i32 Threads>
+void bench_queue() {
+    Queue queue(1024);
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < Threads; ++t) {
+        threads.emplace_back([&] {
+            for (i64 i = 0; i < BENCH_QUEUE_ITEMS / Threads; ++i) {
+                while (!queue.try_push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            i64 value = 0;
+            for (i64 i = 0; i < BENCH_QUEUE_ITEMS / Threads; ++i) {
+                while (!queue.try_pop(value)) {
+                    std::this_thread::yield();
+                }
+                BENCH_SINK += value;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+BENCH_THROUGHPUT("Queue Spsc 1P/1C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::SpscQueue<i64>, 1>());
+BENCH_THROUGHPUT("Queue Mutex 1P/1C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 1>());
+BENCH_THROUGHPUT("Queue Mpmc 1P/1C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 1>());
+BENCH_THROUGHPUT("Queue Mutex 2P/2C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 2>());
+BENCH_THROUGHPUT("Queue Mpmc 2P/2C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 2>());
+BENCH_THROUGHPUT("Queue Mutex 4P/4C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 4>());
+BENCH_THROUGHPUT("Queue Mpmc 4P/4C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 4>());
+BENCH_THROUGHPUT("Queue Mutex 8P/8C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 8>());
+BENCH_THROUGHPUT("Queue Mpmc 8P/8C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 8>());
+BENCH_THROUGHPUT("Queue Mutex 16P/16C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 16>());
+BENCH_THROUGHPUT("Queue Mpmc 16P/16C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 16>());
+BENCH_THROUGHPUT("Queue Mutex 32P/32C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<MutexQueue<i64>, 32>());
+BENCH_THROUGHPUT("Queue Mpmc 32P/32C", BENCH_COUNT, BENCH_QUEUE_ITEMS, 0, bench_queue<bee::MpmcQueue<i64>, 32>());
+
+// Round trips through a pair of queues, items/s is the inverse of the latency
+inline constexpr i64 BENCH_PING_PONGS = 10'000;
+
+template <typename Queue>
+void bench_ping_pong() {
+    Queue ping(16);
+    Queue pong(16);
+    auto const wait = [](auto &&try_op) {
+        while (!try_op()) {
+            std::this_thread::yield();
+        }
+    };
+    std::thread echo([&] {
+        i64 value = 0;
+        for (i64 i = 0; i < BENCH_PING_PONGS; ++i) {
+            wait([&] { return ping.try_pop(value); });
+            wait([&] { return pong.try_push(value); });
+        }
+    });
+    i64 value = 0;
+    for (i64 i = 0; i < BENCH_PING_PONGS; ++i) {
+        wait([&] { return ping.try_push(i); });
+        wait([&] { return pong.try_pop(value); });
+    }
+    echo.join();
+}
+
+BENCH_THROUGHPUT("Latency Mutex", BENCH_COUNT, BENCH_PING_PONGS, 0, bench_ping_pong<MutexQueue<i64>>());
+BENCH_THROUGHPUT("Latency Spsc", BENCH_COUNT, BENCH_PING_PONGS, 0, bench_ping_pong<bee::SpscQueue<i64>>());
+BENCH_THROUGHPUT("Latency Mpmc", BENCH_COUNT, BENCH_PING_PONGS, 0, bench_ping_pong<bee::MpmcQueue<i64>>());
+
+
+// ==============================================
+// ========== Lock contention
+
+inline constexpr i32 BENCH_LOCKS = 20'000;
+
+template <typename Lock, i32 Threads>
+void bench_contention() {
+    Lock lock;
+    i64 counter = 0;
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < Threads; ++t) {
+        threads.emplace_back([&] {
+            for (i32 i = 0; i < BENCH_LOCKS / Threads; ++i) {
+                bee_lock(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    BENCH_SINK += counter;
+}
+
+BENCH_THROUGHPUT("Contention std::mutex 1T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<std::mutex, 1>());
+BENCH_THROUGHPUT("Contention std::shared_mutex 1T", BENCH_COUNT, BENCH_LOCKS, 0,
+                 bench_contention<std::shared_mutex, 1>());
+BENCH_THROUGHPUT("Contention Spinlock 1T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Spinlock, 1>());
+BENCH_THROUGHPUT("Contention Mutex 1T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Mutex, 1>());
+BENCH_THROUGHPUT("Contention std::mutex 4T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<std::mutex, 4>());
+BENCH_THROUGHPUT("Contention std::shared_mutex 4T", BENCH_COUNT, BENCH_LOCKS, 0,
+                 bench_contention<std::shared_mutex, 4>());
+BENCH_THROUGHPUT("Contention Spinlock 4T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Spinlock, 4>());
+BENCH_THROUGHPUT("Contention Mutex 4T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Mutex, 4>());
+BENCH_THROUGHPUT("Contention std::mutex 16T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<std::mutex, 16>());
+BENCH_THROUGHPUT("Contention std::shared_mutex 16T", BENCH_COUNT, BENCH_LOCKS, 0,
+                 bench_contention<std::shared_mutex, 16>());
+BENCH_THROUGHPUT("Contention Spinlock 16T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Spinlock, 16>());
+BENCH_THROUGHPUT("Contention Mutex 16T", BENCH_COUNT, BENCH_LOCKS, 0, bench_contention<bee::Mutex, 16>());
+
+// Read-mostly config: 4 readers, 1 writer publishing every few reads
+struct BenchConfig {
+    i64 version;
+    f64 scale, offset;
+};
+
+inline constexpr i32 BENCH_CONFIG_READS = 50'000;
+
+template <typename Store, typename Load>
+void bench_read_mostly(Store &&store, Load &&load) {
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (i32 i = 0; i < BENCH_CONFIG_READS; ++i) {
+                BENCH_SINK += load().version;
+            }
+        });
+    }
+    for (i64 i = 0; i < BENCH_CONFIG_READS / 100; ++i) {
+        store(BenchConfig { i, 1.0, 0.0 });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+BENCH_THROUGHPUT("ReadMostly std::shared_mutex", BENCH_COUNT, 4 * BENCH_CONFIG_READS, 0, {
+    std::shared_mutex mtx;
+    BenchConfig config {};
+    bench_read_mostly(
+            [&](BenchConfig const &value) {
+                bee_lock(mtx);
+                config = value;
+            },
+            [&] {
+                bee_lock_shared(mtx);
+                return config;
+            });
+});
+BENCH_THROUGHPUT("ReadMostly SeqLock", BENCH_COUNT, 4 * BENCH_CONFIG_READS, 0, {
+    bee::SeqLock<BenchConfig> config;
+    bench_read_mostly([&](BenchConfig const &value) { config.store(value); }, [&] { return config.load(); });
+});
+
+
+// ==============================================
+// ========== Snapshot handoff
+
+struct BenchFrame {
+    i64 id = 0;
+    Arr<f32, 1024> values {};
+};
+
+inline constexpr i32 BENCH_SNAPSHOT_READS = 20'000;
+
+// The writer keeps producing frames until every reader is done
+template <typename Publish, typename Read>
+void bench_snapshots(i32 readers, Publish &&publish, Read &&read) {
+    std::atomic<i32> running = readers;
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < readers; ++t) {
+        threads.emplace_back([&] {
+            for (i32 i = 0; i < BENCH_SNAPSHOT_READS; ++i) {
+                BENCH_SINK += read();
+            }
+            --running;
+        });
+    }
+    BenchFrame frame;
+    while (running > 0) {
+        frame.id += 1;
+        frame.values[0] = as(f32, frame.id);
+        publish(frame);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+template <i32 Readers>
+void bench_snapshots_mutex() {
+    std::mutex mtx;
+    BenchFrame shared;
+    bench_snapshots(
+            Readers,
+            [&](BenchFrame const &frame) {
+                bee_lock(mtx);
+                shared = frame;
+            },
+            [&] {
+                BenchFrame copy;
+                {
+                    bee_lock(mtx);
+                    copy = shared;
+                }
+                return copy.id;
+            });
+}
+
+BENCH_THROUGHPUT("Snapshot mutex+copy 1R", BENCH_COUNT, BENCH_SNAPSHOT_READS, 0, bench_snapshots_mutex<1>());
+BENCH_THROUGHPUT("Snapshot TripleBuffer 1R", BENCH_COUNT, BENCH_SNAPSHOT_READS, 0, {
+    static bee::TripleBuffer<BenchFrame> triple;
+    bench_snapshots(
+            1,
+            [&](BenchFrame const &frame) {
+                BenchFrame &back = triple.write_buffer();
+                back.id = frame.id;
+                back.values[0] = frame.values[0];
+                triple.publish();
+            },
+            [&] { return triple.latest().id; });
+});
+BENCH_THROUGHPUT("Snapshot mutex+copy 4R", BENCH_COUNT, 4 * BENCH_SNAPSHOT_READS, 0, bench_snapshots_mutex<4>());
+BENCH_THROUGHPUT("Snapshot LatestCell 4R", BENCH_COUNT, 4 * BENCH_SNAPSHOT_READS, 0, {
+    bee::LatestCell<BenchFrame> cell;
+    bench_snapshots(
+            4, [&](BenchFrame const &frame) { cell.publish(frame); }, [&] { return cell.read()->id; });
+});
+
+
+// ==============================================
+// ========== Timeouts, wheel vs ordered containers
+
+inline constexpr u64 BENCH_TIMERS = 500'000;
+
+// Schedule every timer over ~10s of 1ms ticks, cancel every other one, then expire the rest
+inline i64 bench_timer_delay(u64 i) { return as(i64, (i * 2'654'435'761ull) % 10'000) * 1'000'000; }
+
+BENCH_THROUGHPUT("Timers priority_queue", BENCH_COUNT, BENCH_TIMERS, 0, {
+    using Entry = std::pair<i64, u64>;
+    std::priority_queue<Entry, Vec<Entry>, std::greater<>> queue;
+    Vec<b8> cancelled(BENCH_TIMERS, false);
+    for (u64 i = 0; i < BENCH_TIMERS; ++i) {
+        queue.push({ bench_timer_delay(i), i });
+    }
+    for (u64 i = 0; i < BENCH_TIMERS; i += 2) {
+        cancelled[i] = true; // Lazy cancel, skipped on pop
+    }
+    for (i64 now = 0; now < 10'000'000'000; now += 1'000'000) {
+        while (!queue.empty() && queue.top().first <= now) {
+            BENCH_SINK += !cancelled[queue.top().second];
+            queue.pop();
+        }
+    }
+});
+BENCH_THROUGHPUT("Timers Omap", BENCH_COUNT, BENCH_TIMERS, 0, {
+    Omap<std::pair<i64, u64>, u64> timers;
+    for (u64 i = 0; i < BENCH_TIMERS; ++i) {
+        timers.emplace(std::pair(bench_timer_delay(i), i), i);
+    }
+    for (u64 i = 0; i < BENCH_TIMERS; i += 2) {
+        timers.erase({ bench_timer_delay(i), i });
+    }
+    for (i64 now = 0; now < 10'000'000'000; now += 1'000'000) {
+        while (!timers.empty() && timers.begin()->first.first <= now) {
+            BENCH_SINK += 1;
+            timers.erase(timers.begin());
+        }
+    }
+});
+BENCH_THROUGHPUT("Timers TimerWheel", BENCH_COUNT, BENCH_TIMERS, 0, {
+    bee::TimerWheel wheel(1'000'000, 0);
+    Vec<bee::TimerId> ids(BENCH_TIMERS);
+    for (u64 i = 0; i < BENCH_TIMERS; ++i) {
+        ids[i] = wheel.schedule_at(bench_timer_delay(i), i);
+    }
+    for (u64 i = 0; i < BENCH_TIMERS; i += 2) {
+        wheel.cancel(ids[i]);
+    }
+    for (i64 now = 0; now < 10'000'000'000; now += 1'000'000) {
+        BENCH_SINK += as(i64, wheel.advance(now, [](bee::TimerId, u64) {}));
+    }
+});
+
+
+// ==============================================
+// ========== Hashing and caches
+
+inline Vec<Str> const &bench_cache_keys() {
+    static Vec<Str> const keys = [] {
+        Vec<Str> keys;
+        for (i32 i = 0; i < 10'000; ++i) {
+            keys.push_back("assets/textures/some_long_folder_name/file_" + std::to_string(i) + ".png");
+        }
+        return keys;
+    }();
+    return keys;
+}
+
+BENCH_THROUGHPUT("Hash std::hash<Str>", BENCH_COUNT, 10'000, 0, {
+    for (auto const &key : bench_cache_keys()) {
+        BENCH_SINK += as(i64, std::hash<Str> {}(key) & 1);
+    }
+});
+BENCH_THROUGHPUT("Hash bee::Hasher", BENCH_COUNT, 10'000, 0, {
+    for (auto const &key : bench_cache_keys()) {
+        BENCH_SINK += as(i64, bee::Hasher {}(key) & 1);
+    }
+});
+
+inline constexpr i32 BENCH_CACHE_OPS = 200'000;
+
+// 90% reads over a hot key set, a miss stores the value
+template <typename Get, typename Put>
+void bench_cache(i32 threads_count, Get &&get, Put &&put) {
+    auto const &keys = bench_cache_keys();
+    Vec<std::thread> threads;
+    for (i32 t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (i32 i = 0; i < BENCH_CACHE_OPS / threads_count; ++i) {
+                Str const &key = keys[(as(usize, i) * 7919 + as(usize, t) * 104'729) % keys.size()];
+                if (i % 10 == 0 || !get(key)) {
+                    put(key, i);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+template <i32 Threads>
+void bench_cache_umap() {
+    std::mutex mtx;
+    Umap<Str, i64> map;
+    bench_cache(
+            Threads,
+            [&](Str const &key) {
+                bee_lock(mtx);
+                auto const it = map.find(key);
+                return it != map.end() && (BENCH_SINK += it->second & 1, true);
+            },
+            [&](Str const &key, i64 value) {
+                bee_lock(mtx);
+                map[key] = value;
+            });
+}
+
+template <i32 Threads>
+void bench_cache_lru() {
+    bee::LruCache<Str, i64> lru(4 * 1024 * 1024);
+    bench_cache(
+            Threads,
+            [&](Str const &key) {
+                auto const value = lru.get(key);
+                return value && (BENCH_SINK += *value & 1, true);
+            },
+            [&](Str const &key, i64 value) { lru.put(key, value); });
+}
+
+BENCH_THROUGHPUT("Cache Umap+mutex 1T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_umap<1>());
+BENCH_THROUGHPUT("Cache LruCache 1T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_lru<1>());
+BENCH_THROUGHPUT("Cache Umap+mutex 4T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_umap<4>());
+BENCH_THROUGHPUT("Cache LruCache 4T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_lru<4>());
+BENCH_THROUGHPUT("Cache Umap+mutex 16T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_umap<16>());
+BENCH_THROUGHPUT("Cache LruCache 16T", BENCH_COUNT, BENCH_CACHE_OPS, 0, bench_cache_lru<16>());
+
+
+// ==============================================
+// ========== Memoized hits, type-erased vs bee::memoize
+
+inline i64 bench_memo_work(Str const &name, i32 level) { return as(i64, name.size()) * level; }
+
+BENCH_THROUGHPUT("Memo Fn+Omap<tuple>", BENCH_COUNT, BENCH_CACHE_OPS, 0, {
+    Fn<i64(Str const &, i32)> fn = bench_memo_work;
+    Omap<std::tuple<Str, i32>, i64> cache;
+    auto const &keys = bench_cache_keys();
+    for (i32 i = 0; i < BENCH_CACHE_OPS; ++i) {
+        Str const &key = keys[as(usize, i) % 1000];
+        auto const it = cache.find({ key, i & 3 });
+        BENCH_SINK += it != cache.end() ? it->second : (cache[{ key, i & 3 }] = fn(key, i & 3));
+    }
+});
+BENCH_THROUGHPUT("Memo bee::memoize", BENCH_COUNT, BENCH_CACHE_OPS, 0, {
+    auto memo = bee::memoize(&bench_memo_work);
+    auto const &keys = bench_cache_keys();
+    for (i32 i = 0; i < BENCH_CACHE_OPS; ++i) {
+        BENCH_SINK += memo(keys[as(usize, i) % 1000], i & 3);
+    }
+});
+BENCH_THROUGHPUT("Memo bee::memoize<ThreadSafe>", BENCH_COUNT, BENCH_CACHE_OPS, 0, {
+    auto memo = bee::memoize<true>(&bench_memo_work);
+    auto const &keys = bench_cache_keys();
+    for (i32 i = 0; i < BENCH_CACHE_OPS; ++i) {
+        BENCH_SINK += memo(keys[as(usize, i) % 1000], i & 3);
+    }
+});
+
+
+// ==============================================
+// ========== Large file reads, copies vs mapping
+
+inline constexpr usize BENCH_BIG_FILE_SIZE = 64 * 1024 * 1024;
+
+inline Str const &bench_big_file() {
+    static Str const path = [] {
+        auto const file = (bee::fs::temp_directory_path() / "bee_bench_big_file.bin").string();
+        Str content(BENCH_BIG_FILE_SIZE, 'x');
+        for (usize i = 0; i < content.size(); i += 80) {
+            content[i] = '\n';
+        }
+        if (!bee::file_write_trunc(file, content)) {
+            bee_err("Can't write {}", file);
+        }
+        return file;
+    }();
+    return path;
+}
+
+BENCH_THROUGHPUT("BigFile file_read", BENCH_COUNT, 1, BENCH_BIG_FILE_SIZE, {
+    Str const content = bee::file_read(bench_big_file());
+    BENCH_SINK += std::count(content.begin(), content.end(), '\n');
+});
+BENCH_THROUGHPUT("BigFile bin_read", BENCH_COUNT, 1, BENCH_BIG_FILE_SIZE, {
+    Vec<u8> const content = bee::bin_read(bench_big_file());
+    BENCH_SINK += std::count(content.begin(), content.end(), '\n');
+});
+BENCH_THROUGHPUT("BigFile file_view", BENCH_COUNT, 1, BENCH_BIG_FILE_SIZE, {
+    auto const file = bee::file_view(bench_big_file());
+    BENCH_SINK += std::count(file.view().begin(), file.view().end(), '\n');
+});
+
+
+// ==============================================
+// ========== Bulk reads, istreambuf_iterator vs fstat + read()
+
+// #define BEE_BENCH_READ_1G // Needs 1 GiB of disk and 2 GiB of memory
+
+inline Str bench_io_file(usize size) {
+    auto const path = (bee::fs::temp_directory_path() / ("bee_bench_io_" + std::to_string(size) + ".bin")).string();
+    if (!bee::fs::exists(path) || bee::fs::file_size(path) != size) {
+        Str const chunk(std::min<usize>(size, 16 * 1024 * 1024), 'x');
+        bee::fs::remove(path);
+        for (usize written = 0; written < size; written += chunk.size()) {
+            bee::file_write_append(path, chunk.data(), std::min(chunk.size(), size - written));
+        }
+    }
+    return path;
+}
+
+// What bin_read used to do
+inline Vec<u8> bench_bin_read_istreambuf(Str const &path) {
+    std::ifstream file { path, std::ios::binary };
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+template <usize Size, i32 Reads>
+void bench_bulk_read(i32 mode) {
+    static Str const path = bench_io_file(Size);
+    static Vec<u8> reused;
+    for (i32 i = 0; i < Reads; ++i) {
+        if (mode == 0) {
+            BENCH_SINK += as(i64, bench_bin_read_istreambuf(path).size());
+        } else if (mode == 1) {
+            BENCH_SINK += as(i64, bee::bin_read(path).size());
+        } else {
+            bee::bin_read(path, reused);
+            BENCH_SINK += as(i64, reused.size());
+        }
+    }
+}
+
+BENCH_THROUGHPUT("BinRead 4K istreambuf", BENCH_COUNT, 1000, 1000 * 4096, bench_bulk_read<4096, 1000>(0));
+BENCH_THROUGHPUT("BinRead 4K bin_read", BENCH_COUNT, 1000, 1000 * 4096, bench_bulk_read<4096, 1000>(1));
+BENCH_THROUGHPUT("BinRead 4K bin_read reuse", BENCH_COUNT, 1000, 1000 * 4096, bench_bulk_read<4096, 1000>(2));
+BENCH_THROUGHPUT("BinRead 1M istreambuf", BENCH_COUNT, 16, 16 << 20, bench_bulk_read<1 << 20, 16>(0));
+BENCH_THROUGHPUT("BinRead 1M bin_read", BENCH_COUNT, 16, 16 << 20, bench_bulk_read<1 << 20, 16>(1));
+BENCH_THROUGHPUT("BinRead 1M bin_read reuse", BENCH_COUNT, 16, 16 << 20, bench_bulk_read<1 << 20, 16>(2));
+#ifdef BEE_BENCH_READ_1G
+BENCH_THROUGHPUT("BinRead 1G istreambuf", 1, 1, 1 << 30, bench_bulk_read<1 << 30, 1>(0));
+BENCH_THROUGHPUT("BinRead 1G bin_read", 1, 1, 1 << 30, bench_bulk_read<1 << 30, 1>(1));
+BENCH_THROUGHPUT("BinRead 1G bin_read reuse", 1, 1, 1 << 30, bench_bulk_read<1 << 30, 1>(2));
+#endif
+
+
+// ==============================================
+// ========== Many small appends, open/close per call vs FileWriter
+
+inline constexpr i32 BENCH_APPENDS = 10'000;
+inline constexpr std::string_view BENCH_APPEND_LINE = "2024-01-01 00:00:00 [INFO] metric.name=42 tag=value\n";
+inline constexpr usize BENCH_APPEND_BYTES = BENCH_APPENDS * BENCH_APPEND_LINE.size();
+
+inline Str bench_append_path() {
+    return (bee::fs::temp_directory_path() / "bee_bench_appends.log").string();
+}
+
+BENCH_THROUGHPUT("Appends file_write_append", BENCH_COUNT, BENCH_APPENDS, BENCH_APPEND_BYTES, {
+    bee::fs::remove(bench_append_path());
+    for (i32 i = 0; i < BENCH_APPENDS; ++i) {
+        bee::file_write_append(bench_append_path(), BENCH_APPEND_LINE.data(), BENCH_APPEND_LINE.size());
+    }
+});
+BENCH_THROUGHPUT("Appends FileWriter", BENCH_COUNT, BENCH_APPENDS, BENCH_APPEND_BYTES, {
+    bee::FileWriter writer(bench_append_path(), bee::WriteMode::Trunc);
+    for (i32 i = 0; i < BENCH_APPENDS; ++i) {
+        writer.write(BENCH_APPEND_LINE);
+    }
+});
+BENCH_THROUGHPUT("Appends FileWriter writev", BENCH_COUNT, BENCH_APPENDS, BENCH_APPEND_BYTES, {
+    bee::FileWriter writer(bench_append_path(), bee::WriteMode::Trunc, {}, 0); // Unbuffered, one syscall per batch
+    Arr<std::string_view, 100> batch;
+    batch.fill(BENCH_APPEND_LINE);
+    for (i32 i = 0; i < BENCH_APPENDS; i += 100) {
+        writer.writev(batch);
+    }
+});
+BENCH_THROUGHPUT("Appends FileWriter fsync 64K", BENCH_COUNT, BENCH_APPENDS, BENCH_APPEND_BYTES, {
+    bee::FileWriter writer(bench_append_path(), bee::WriteMode::Trunc, { .every_bytes = 64 * 1024 });
+    for (i32 i = 0; i < BENCH_APPENDS; ++i) {
+        writer.write(BENCH_APPEND_LINE);
+    }
+});
+
+
+// ==============================================
+// ========== Replacing and copying files
+
+inline constexpr usize BENCH_COPY_SIZE = 64 << 20;
+
+BENCH_THROUGHPUT("Replace file_write_trunc", BENCH_COUNT, 20, 20 * BENCH_APPEND_LINE.size(), {
+    for (i32 i = 0; i < 20; ++i) {
+        (void)bee::file_write_trunc(bench_append_path(), BENCH_APPEND_LINE.data(), BENCH_APPEND_LINE.size());
+    }
+});
+BENCH_THROUGHPUT("Replace file_write_atomic", BENCH_COUNT, 20, 20 * BENCH_APPEND_LINE.size(), {
+    for (i32 i = 0; i < 20; ++i) {
+        (void)bee::file_write_atomic(bench_append_path(), BENCH_APPEND_LINE);
+    }
+});
+BENCH_THROUGHPUT("Copy 64M streams", BENCH_COUNT, 1, BENCH_COPY_SIZE, {
+    static Str const source = bench_io_file(BENCH_COPY_SIZE);
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(source + ".copy", std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+});
+BENCH_THROUGHPUT("Copy 64M file_copy", BENCH_COUNT, 1, BENCH_COPY_SIZE, {
+    static Str const source = bench_io_file(BENCH_COPY_SIZE);
+    (void)bee::file_copy(source, source + ".copy");
+});
+
+
+// ==============================================
+// ========== Binary parsing, manual offsets + memcpy vs BinReader
+
+inline constexpr usize BENCH_BIN_RECORDS = 1'000'000;
+inline constexpr usize BENCH_BIN_RECORD_SIZE = sizeof(u32) + 3 * sizeof(f32);
+
+inline Vec<u8> const BENCH_BIN_BYTES = [] { // Built before the benches run
+    Vec<u8> out;
+    bee::BinWriter writer(out);
+    for (usize i = 0; i < BENCH_BIN_RECORDS; ++i) {
+        writer.write(as(u32, i));
+        writer.write(as(f32, i));
+        writer.write(as(f32, i) * 0.5f);
+        writer.write(as(f32, i) * 0.25f);
+    }
+    return out;
+}();
+
+BENCH_THROUGHPUT("BinParse memcpy", BENCH_COUNT, BENCH_BIN_RECORDS, BENCH_BIN_RECORDS * BENCH_BIN_RECORD_SIZE, {
+    auto const &bytes = BENCH_BIN_BYTES;
+    usize offset = 0;
+    f32 sum = 0;
+    while (offset + BENCH_BIN_RECORD_SIZE <= bytes.size()) {
+        u32 id = 0;
+        Arr<f32, 3> position {};
+        std::memcpy(&id, bytes.data() + offset, sizeof(id));
+        std::memcpy(position.data(), bytes.data() + offset + sizeof(id), sizeof(position));
+        offset += BENCH_BIN_RECORD_SIZE;
+        sum += as(f32, id) + position[0] + position[1] + position[2];
+    }
+    BENCH_SINK += as(i64, sum);
+});
+BENCH_THROUGHPUT("BinParse BinReader", BENCH_COUNT, BENCH_BIN_RECORDS, BENCH_BIN_RECORDS * BENCH_BIN_RECORD_SIZE, {
+    bee::BinReader reader(BENCH_BIN_BYTES);
+    f32 sum = 0;
+    while (!reader.at_end()) {
+        sum += as(f32, reader.read<u32>()) + reader.read<f32>() + reader.read<f32>() + reader.read<f32>();
+    }
+    BENCH_SINK += as(i64, sum);
+});
+BENCH_THROUGHPUT("BinParse BinReader span", BENCH_COUNT, BENCH_BIN_RECORDS, BENCH_BIN_RECORDS * BENCH_BIN_RECORD_SIZE, {
+    bee::BinReader reader(BENCH_BIN_BYTES);
+    auto const words = reader.read_span<u32>(BENCH_BIN_BYTES.size() / sizeof(u32)); // Same 16-byte layout, in place
+    f32 sum = 0;
+    for (usize i = 0; i + 3 < words.size(); i += 4) {
+        sum += as(f32, words[i]) + std::bit_cast<f32>(words[i + 1]) + std::bit_cast<f32>(words[i + 2]) +
+               std::bit_cast<f32>(words[i + 3]);
+    }
+    BENCH_SINK += as(i64, sum);
+});
+
+
+// ==============================================
+// ========== Line counting, whole file in memory vs streamed
+
+inline constexpr usize BENCH_LINES_SIZE = 64 << 20;
+
+inline Str bench_lines_file() {
+    auto const path = (bee::fs::temp_directory_path() / "bee_bench_lines.log").string();
+    if (!bee::fs::exists(path) || bee::fs::file_size(path) != BENCH_LINES_SIZE) {
+        bee::FileWriter writer(path, bee::WriteMode::Trunc);
+        for (usize written = 0; written < BENCH_LINES_SIZE; written += BENCH_APPEND_LINE.size()) {
+            writer.write(BENCH_APPEND_LINE.substr(0, std::min(BENCH_APPEND_LINE.size(), BENCH_LINES_SIZE - written)));
+        }
+    }
+    return path;
+}
+
+BENCH_THROUGHPUT("Lines file_read+split", BENCH_COUNT, 1, BENCH_LINES_SIZE, {
+    static Str const path = bench_lines_file();
+    BENCH_SINK += as(i64, bee::str_split(bee::file_read(path), "\n").size());
+});
+BENCH_THROUGHPUT("Lines LineReader", BENCH_COUNT, 1, BENCH_LINES_SIZE, {
+    static Str const path = bench_lines_file();
+    bee::LineReader reader(path);
+    reader.for_each([](std::string_view line) { BENCH_SINK += as(i64, line.size() > 0); });
+});
+
+
+// ==============================================
+// ========== Many small files, one by one vs batched through IoRing
+
+#ifdef BEE_HAS_POSIX_IO
+
+inline constexpr i32 BENCH_SMALL_FILES = 2000;
+inline constexpr usize BENCH_SMALL_FILE_SIZE = 4096;
+
+inline Vec<Str> const &bench_many_files() {
+    static Vec<Str> const paths = [] {
+        auto const dir = bee::fs::temp_directory_path() / "bee_bench_many_files";
+        bee::fs::create_directories(dir);
+        Str const content(BENCH_SMALL_FILE_SIZE, 'x');
+        Vec<Str> out;
+        for (i32 i = 0; i < BENCH_SMALL_FILES; ++i) {
+            out.push_back((dir / (std::to_string(i) + ".bin")).string());
+            if (!bee::fs::exists(out.back())) {
+                (void)bee::file_write_trunc(out.back(), content.data(), content.size());
+            }
+        }
+        return out;
+    }();
+    return paths;
+}
+
+BENCH_THROUGHPUT("SmallFiles file_read", BENCH_COUNT, BENCH_SMALL_FILES, BENCH_SMALL_FILES * BENCH_SMALL_FILE_SIZE, {
+    for (Str const &path : bench_many_files()) {
+        BENCH_SINK += as(i64, bee::file_read(path).size());
+    }
+});
+BENCH_THROUGHPUT("SmallFiles IoRing", BENCH_COUNT, BENCH_SMALL_FILES, BENCH_SMALL_FILES * BENCH_SMALL_FILE_SIZE, {
+    static bee::IoRing ring;
+    for (Str const &content : bee::file_read_many(bench_many_files(), ring)) {
+        BENCH_SINK += as(i64, content.size());
+    }
+});
+BENCH_THROUGHPUT("SmallFiles IoRing pool", BENCH_COUNT, BENCH_SMALL_FILES, BENCH_SMALL_FILES * BENCH_SMALL_FILE_SIZE, {
+    static bee::IoRing ring(256, bee::thread_pool(), false);
+    for (Str const &content : bee::file_read_many(bench_many_files(), ring)) {
+        BENCH_SINK += as(i64, content.size());
+    }
+});
+
+#endif
+
+
+// ==============================================
+// ========== Directory trees, single-threaded walk + reads vs dir_scan + files_load
+
+// #define BEE_BENCH_TREE_100K // Writes 100K small files to the temp directory
+#ifdef BEE_BENCH_TREE_100K
+inline constexpr i32 BENCH_TREE_FILES = 100'000;
+#else
+inline constexpr i32 BENCH_TREE_FILES = 10'000;
+#endif
+inline constexpr usize BENCH_TREE_FILE_SIZE = 1024;
+inline constexpr usize BENCH_TREE_BYTES = BENCH_TREE_FILES / 2 * BENCH_TREE_FILE_SIZE; // Only '.txt' are loaded
+
+inline Str bench_tree() {
+    auto const root = bee::fs::temp_directory_path() / ("bee_bench_tree_" + std::to_string(BENCH_TREE_FILES));
+    if (!bee::fs::exists(root / "done")) {
+        Str const content(BENCH_TREE_FILE_SIZE, 'x');
+        for (i32 i = 0; i < BENCH_TREE_FILES; ++i) {
+            auto const dir = root / std::to_string(i % 10) / std::to_string(i % 100);
+            bee::fs::create_directories(dir);
+            auto const name = std::to_string(i) + (i % 2 ? ".bin" : ".txt");
+            (void)bee::file_write_trunc((dir / name).string(), content);
+        }
+        std::ofstream { root / "done" };
+    }
+    return root.string();
+}
+
+BENCH_THROUGHPUT("Tree recursive_directory_iterator", BENCH_COUNT, BENCH_TREE_FILES, 0, {
+    static Str const root = bench_tree();
+    for (auto const &entry : bee::fs::recursive_directory_iterator(root)) {
+        BENCH_SINK += entry.is_regular_file() && bee::file_check_extension(entry.path().string(), "txt");
+    }
+});
+BENCH_THROUGHPUT("Tree dir_scan", BENCH_COUNT, BENCH_TREE_FILES, 0, {
+    static Str const root = bench_tree();
+    BENCH_SINK += as(i64, bee::dir_scan(root, { .extensions = { "txt" } }).size());
+});
+BENCH_THROUGHPUT("Tree load file_read", BENCH_COUNT, BENCH_TREE_FILES / 2, BENCH_TREE_BYTES, {
+    static Vec<Str> const paths = bee::dir_scan(bench_tree(), { .extensions = { "txt" } });
+    for (Str const &path : paths) {
+        BENCH_SINK += as(i64, bee::file_read(path).size());
+    }
+});
+BENCH_THROUGHPUT("Tree load files_load", BENCH_COUNT, BENCH_TREE_FILES / 2, BENCH_TREE_BYTES, {
+    static Vec<Str> const paths = bee::dir_scan(bench_tree(), { .extensions = { "txt" } });
+    Vec<Str> contents;
+    (void)bee::files_load(paths, contents);
+    BENCH_SINK += as(i64, contents.size());
+});
+BENCH_THROUGHPUT("Tree load files_load arena", BENCH_COUNT, BENCH_TREE_FILES / 2, BENCH_TREE_BYTES, {
+    static Vec<Str> const paths = bee::dir_scan(bench_tree(), { .extensions = { "txt" } });
+    static bee::ScratchArena arena(16 << 20);
+    Vec<std::string_view> contents;
+    (void)bee::files_load(paths, arena, contents);
+    arena.reset();
+    BENCH_SINK += as(i64, contents.size());
+});
+
+
+// ==============================================
+// ========== Repeated reads of the same file, file_read vs FileCache
+
+inline constexpr i32 BENCH_CACHED_READS = 10'000;
+
+inline Str bench_cached_file() {
+    static Str const path = [] {
+        auto const file = (bee::fs::temp_directory_path() / "bee_bench_config.json").string();
+        (void)bee::file_write_trunc(file, Str(4096, 'c'));
+        return file;
+    }();
+    return path;
+}
+
+BENCH_THROUGHPUT("Cached file_read", BENCH_COUNT, BENCH_CACHED_READS, 0, {
+    for (i32 i = 0; i < BENCH_CACHED_READS; ++i) {
+        BENCH_SINK += as(i64, bee::file_read(bench_cached_file()).size());
+    }
+});
+BENCH_THROUGHPUT("Cached FileCache stat", BENCH_COUNT, BENCH_CACHED_READS, 0, {
+    static bee::FileCache cache;
+    for (i32 i = 0; i < BENCH_CACHED_READS; ++i) {
+        BENCH_SINK += as(i64, cache.get(bench_cached_file())->size());
+    }
+});
+BENCH_THROUGHPUT("Cached FileCache watch", BENCH_COUNT, BENCH_CACHED_READS, 0, {
+    static bee::FileCache cache({ .watch = true });
+    for (i32 i = 0; i < BENCH_CACHED_READS; ++i) {
+        BENCH_SINK += as(i64, cache.get(bench_cached_file())->size());
+    }
+});
+
+
 // ==============================================
 // ========== Glm stuff
 